@@ -20,6 +20,7 @@ from esphome.core import CORE, coroutine_with_priority
 import esphome.final_validate as fv
 
 CODEOWNERS = ["@pihiandreas"]
+AUTO_LOAD = ["i2c_link"]  # the I2C port pool, shared with i2c_slave
 i2c_master_ns = cg.esphome_ns.namespace("i2c")
 I2CBus = i2c_master_ns.class_("I2CBus")
 IDFI2CBus = i2c_master_ns.class_("IDFI2CBus", I2CBus, cg.Component)
@@ -28,6 +29,8 @@ I2CDevice = i2c_master_ns.class_("I2CDevice")
 
 CONF_SDA_PULLUP_ENABLED = "sda_pullup_enabled"
 CONF_SCL_PULLUP_ENABLED = "scl_pullup_enabled"
+CONF_SPLIT_TURNAROUND = "split_turnaround"
+CONF_ADAPTIVE_TURNAROUND = "adaptive_turnaround"
 MULTI_CONF = True
 
 
@@ -42,6 +45,12 @@ pin_with_input_and_output_support = pins.internal_gpio_pin_number(
 )
 
 
+def _validate_turnaround(config):
+    if config[CONF_ADAPTIVE_TURNAROUND] and CONF_SPLIT_TURNAROUND not in config:
+        raise cv.Invalid(f"'{CONF_ADAPTIVE_TURNAROUND}' requires '{CONF_SPLIT_TURNAROUND}' (the starting value)")
+    return config
+
+
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
@@ -58,10 +67,13 @@ CONFIG_SCHEMA = cv.All(
                 cv.frequency, cv.Range(min=0, min_included=False)
             ),
             cv.Optional(CONF_TIMEOUT): cv.positive_time_period,
+            cv.Optional(CONF_SPLIT_TURNAROUND): cv.positive_time_period,
+            cv.Optional(CONF_ADAPTIVE_TURNAROUND, default=False): cv.boolean,
             cv.Optional(CONF_SCAN, default=True): cv.boolean,
         }
     ).extend(cv.COMPONENT_SCHEMA),
     cv.only_on([PLATFORM_ESP32, PLATFORM_ESP8266, PLATFORM_RP2040]),
+    _validate_turnaround,
 )
 
 
@@ -82,6 +94,9 @@ async def to_code(config):
     cg.add(var.set_scan(config[CONF_SCAN]))
     if CONF_TIMEOUT in config:
         cg.add(var.set_timeout(int(config[CONF_TIMEOUT].total_microseconds)))
+    if CONF_SPLIT_TURNAROUND in config:
+        cg.add(var.set_split_turnaround(int(config[CONF_SPLIT_TURNAROUND].total_microseconds)))
+        cg.add(var.set_adaptive_turnaround(config[CONF_ADAPTIVE_TURNAROUND]))
 
 def i2c_device_schema(default_address):
     """Create a schema for a i2c device.
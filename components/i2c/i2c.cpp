@@ -8,6 +8,11 @@ namespace i2c {
 static const char *const TAG = "i2c";
 
 ErrorCode I2CDevice::read_register(uint8_t a_register, uint8_t *data, size_t len, bool stop) {
+  if (!stop) {
+    // repeated start: register write and read in one transaction
+    ReadBuffer buf{data, len};
+    return bus_->write_readv(address_, &a_register, 1, &buf, 1);
+  }
   ErrorCode err = this->write(&a_register, 1, stop);
   if (err != ERROR_OK)
     return err;
@@ -16,6 +21,11 @@ ErrorCode I2CDevice::read_register(uint8_t a_register, uint8_t *data, size_t len
 
 ErrorCode I2CDevice::read_register16(uint16_t a_register, uint8_t *data, size_t len, bool stop) {
   a_register = convert_big_endian(a_register);
+  if (!stop) {
+    // repeated start: register write and read in one transaction
+    ReadBuffer buf{data, len};
+    return bus_->write_readv(address_, reinterpret_cast<const uint8_t *>(&a_register), 2, &buf, 1);
+  }
   ErrorCode const err = this->write(reinterpret_cast<const uint8_t *>(&a_register), 2, stop);
   if (err != ERROR_OK)
     return err;
@@ -135,6 +135,17 @@ class I2CDevice {
   /// @return an i2c::ErrorCode
   ErrorCode read_register16(uint16_t a_register, uint8_t *data, size_t len, bool stop = true);
 
+  /// @brief writes an array of bytes and then reads into an array of ReadBuffer after a repeated start, in one
+  /// transaction. Useful to fill many values (f.e. a burst of registers) from a single command.
+  /// @param write_data pointer to an array that contains the bytes to send (f.e. a register address or command)
+  /// @param write_len number of bytes to write
+  /// @param buffers pointer to an array of ReadBuffer
+  /// @param cnt number of ReadBuffer to read
+  /// @return an i2c::ErrorCode
+  ErrorCode write_readv(const uint8_t *write_data, size_t write_len, ReadBuffer *buffers, size_t cnt) {
+    return bus_->write_readv(address_, write_data, write_len, buffers, cnt);
+  }
+
   /// @brief writes an array of bytes to a device using an I2CBus
   /// @param data pointer to an array that contains the bytes to send
   /// @param len length of the buffer = number of bytes to write
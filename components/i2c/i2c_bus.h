@@ -91,6 +91,23 @@ class I2CBus {
   /// @details This is a pure virtual method that must be implemented in the subclass.
   virtual ErrorCode writev(uint8_t address, WriteBuffer *buffers, size_t count, bool stop) = 0;
 
+  /// @brief Writes bytes to an I2CBus and then reads bytes into an array of ReadBuffer after a repeated start.
+  /// @param address address of the I²C component on the i2c bus
+  /// @param write_data pointer to an array of bytes that contains the data to be sent (f.e. a register address)
+  /// @param write_len number of bytes to write
+  /// @param buffers pointer to an array of ReadBuffer
+  /// @param count number of ReadBuffer to read
+  /// @return an i2c::ErrorCode
+  /// @details The default implementation issues a write without stop followed by a separate read, subclasses can
+  /// override it to run both phases in a single bus transaction.
+  virtual ErrorCode write_readv(uint8_t address, const uint8_t *write_data, size_t write_len, ReadBuffer *buffers,
+                                size_t count) {
+    ErrorCode err = write(address, write_data, write_len, false);
+    if (err != ERROR_OK)
+      return err;
+    return readv(address, buffers, count);
+  }
+
  protected:
   /// @brief Scans the I2C bus for devices. Devices presence is kept in an array of std::pair
   /// that contains the address and the corresponding bool presence flag.
@@ -1,6 +1,7 @@
 // #ifdef USE_ESP_IDF
 
 #include "i2c_bus_esp_idf.h"
+#include "../i2c_link/i2c_link.h"
 #include <cinttypes>
 #include <cstring>
 #include "esphome/core/application.h"
@@ -41,22 +42,53 @@ void IDFI2CBus::setup() {
   ESP_ERROR_CHECK(gptimer_start(this->gptimer));
 #endif // I2C_DEBUG_TIMING
 
-  static i2c_port_t next_port = I2C_NUM_0;
-  port_ = next_port;
-#if SOC_HP_I2C_NUM > 1
-  next_port = (next_port == I2C_NUM_0) ? I2C_NUM_1 : I2C_NUM_MAX;
-#else
-  next_port = I2C_NUM_MAX;
-#endif
-
-  if (port_ == I2C_NUM_MAX) {
-    ESP_LOGE(TAG, "No more than %u buses supported", SOC_HP_I2C_NUM);
+  // the ports are shared with the i2c slaves configured on the same chip
+  int port = i2c_link::claim_i2c_port(SOC_HP_I2C_NUM);
+  if (port < 0) {
+    ESP_LOGE(TAG, "No free I2C port, the chip has %u for all i2c buses and i2c slaves together", SOC_HP_I2C_NUM);
     this->mark_failed();
     return;
   }
+  port_ = (i2c_port_t) port;
 
-  recover_();
+  this->recovery_result_.store(this->recover_(true), std::memory_order_relaxed);
 
+  this->cmd_link_lock_ = xSemaphoreCreateMutexStatic(&this->cmd_link_lock_buf_);
+  if (this->install_driver_() != ESP_OK) {
+    this->mark_failed();
+    return;
+  }
+  // queues carry pointers to the pool records, every queue can hold the whole pool so submitting never blocks
+  for (auto &queue : this->txn_queue_) {
+    queue = xQueueCreate(I2C_TXN_POOL_SIZE, sizeof(I2CTransaction *));
+    if (queue == NULL) {
+      ESP_LOGW(TAG, "i2c_bus_queue_creation failed");
+      this->mark_failed();
+      return;
+    }
+  }
+  this->done_queue_ = xQueueCreate(I2C_TXN_POOL_SIZE, sizeof(I2CTransaction *));
+  this->txn_ready_ = xSemaphoreCreateCounting(I2C_TXN_POOL_SIZE, 0);
+  if (this->done_queue_ == NULL || this->txn_ready_ == NULL) {
+    ESP_LOGW(TAG, "i2c_bus_queue_creation failed");
+    this->mark_failed();
+    return;
+  }
+  for (auto &txn : this->txn_pool_)
+    this->release_(&txn);
+  if (xTaskCreate(worker_task_, "i2c_bus_task", 1024 * 3, this, 5, NULL) != pdPASS) {
+    ESP_LOGW(TAG, "i2c_bus_task_creation failed");
+    this->mark_failed();
+    return;
+  }
+  initialized_ = true;
+  if (this->scan_) {
+    ESP_LOGV(TAG, "Scanning bus for active devices");
+    this->i2c_scan_();
+  }
+}
+// Configures and installs the legacy master driver, in setup() and again after a runtime bus recovery.
+esp_err_t IDFI2CBus::install_driver_() {
   i2c_config_t conf{};
   memset(&conf, 0, sizeof(conf));
   conf.mode = I2C_MODE_MASTER;
@@ -72,8 +104,7 @@ void IDFI2CBus::setup() {
   esp_err_t err = i2c_param_config(port_, &conf);
   if (err != ESP_OK) {
     ESP_LOGW(TAG, "i2c_param_config failed: %s", esp_err_to_name(err));
-    this->mark_failed();
-    return;
+    return err;
   }
   if (timeout_ > 0) {  // if timeout specified in yaml:
     if (timeout_ > 13000) {
@@ -83,8 +114,7 @@ void IDFI2CBus::setup() {
     err = i2c_set_timeout(port_, timeout_ * 80);  // unit: APB 80MHz clock cycle
     if (err != ESP_OK) {
       ESP_LOGW(TAG, "i2c_set_timeout failed: %s", esp_err_to_name(err));
-      this->mark_failed();
-      return;
+      return err;
     } else {
       ESP_LOGV(TAG, "i2c_timeout set to %" PRIu32 " ticks (%" PRIu32 " us)", timeout_ * 80, timeout_);
     }
@@ -92,22 +122,11 @@ void IDFI2CBus::setup() {
   err = i2c_driver_install(port_, I2C_MODE_MASTER, 0, 0, 0);
   if (err != ESP_OK) {
     ESP_LOGW(TAG, "i2c_driver_install failed: %s", esp_err_to_name(err));
-    this->mark_failed();
-    return;
-  }
-  // this->semaphore_ = xSemaphoreCreateBinary();
-  this->semaphore_ = xSemaphoreCreateMutex();
-  if (this->semaphore_ == NULL) {
-    ESP_LOGW(TAG, "i2c_bus_semaphore_instantiation failed");
-    this->mark_failed();
-    return;
-  }
-  initialized_ = true;
-  if (this->scan_) {
-    ESP_LOGV(TAG, "Scanning bus for active devices");
-    this->i2c_scan_();
+    return err;
   }
+  return ESP_OK;
 }
+
 void IDFI2CBus::dump_config() {
   ESP_LOGCONFIG(TAG, "I2C Bus:");
   ESP_LOGCONFIG(TAG,"  SDA Pin: GPIO%u", this->sda_pin_);
@@ -117,7 +136,13 @@ void IDFI2CBus::dump_config() {
   if (timeout_ > 0) {
     ESP_LOGCONFIG(TAG, "  Timeout: %" PRIu32 "us", this->timeout_);
   }
-  switch (this->recovery_result_) {
+  if (split_turnaround_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Split turnaround: %" PRIu32 "us%s", this->split_turnaround_,
+                  this->adaptive_turnaround_ ? " (adaptive)" : "");
+  }
+  ESP_LOGCONFIG(TAG, "  Runtime recoveries: %u (%u failed)", (unsigned) this->get_recovery_count(),
+                (unsigned) this->get_recovery_failure_count());
+  switch (this->recovery_result_.load(std::memory_order_relaxed)) {
     case RECOVERY_COMPLETED:
       ESP_LOGCONFIG(TAG, "  Recovery: bus successfully recovered");
       break;
@@ -144,6 +169,286 @@ void IDFI2CBus::dump_config() {
   }
 }
 
+I2CTransaction *IDFI2CBus::acquire() {
+  I2CTransaction *txn = this->txn_free_;
+  if (!initialized_ || txn == nullptr)
+    return nullptr;
+  this->txn_free_ = txn->next_free;
+  *txn = {};
+  return txn;
+}
+
+void IDFI2CBus::release_(I2CTransaction *txn) {
+  txn->next_free = this->txn_free_;
+  this->txn_free_ = txn;
+}
+
+bool IDFI2CBus::submit(I2CTransaction *txn) {
+  if (txn->write_len > I2C_TXN_MAX_WRITE || txn->read_len > I2C_TXN_MAX_READ || txn->priority >= PRIORITY_COUNT) {
+    this->release_(txn);
+    return false;
+  }
+  // can't fail, the queues are as large as the pool
+  xQueueSend(this->txn_queue_[txn->priority], &txn, 0);
+  xSemaphoreGive(this->txn_ready_);
+  return true;
+}
+
+void IDFI2CBus::loop() {
+  // hand completed transactions back to their submitters, on the main loop
+  I2CTransaction *txn;
+  while (this->done_queue_ != nullptr && xQueueReceive(this->done_queue_, &txn, 0) == pdTRUE) {
+    if (txn->callback != nullptr)
+      txn->callback(*txn);
+    this->release_(txn);
+  }
+
+  uint32_t recoveries = this->recoveries_.load(std::memory_order_relaxed);
+  if (recoveries != this->recoveries_logged_) {
+    ESP_LOGW(TAG, "Bus recovered at runtime, %u recoveries since boot", (unsigned) recoveries);
+    this->recoveries_logged_ = recoveries;
+  }
+  uint32_t failures = this->recovery_failures_.load(std::memory_order_relaxed);
+  if (failures != this->recovery_failures_logged_) {
+    ESP_LOGE(TAG, "Runtime bus recovery failed, %u failures since boot", (unsigned) failures);
+    this->recovery_failures_logged_ = failures;
+  }
+}
+
+void IDFI2CBus::execute_(I2CTransaction &txn) {
+  if (txn.read_len > 0) {
+    ReadBuffer buf{txn.read_data, txn.read_len};
+    txn.error = txn.write_len > 0 ? this->write_readv(txn.address, txn.write_data, txn.write_len, &buf, 1)
+                                  : this->readv(txn.address, &buf, 1);
+  } else {
+    WriteBuffer buf{txn.write_data, txn.write_len};
+    txn.error = this->writev(txn.address, &buf, 1, true);
+  }
+}
+
+void IDFI2CBus::complete_(I2CTransaction *txn) {
+  ErrorCode error = txn->error;  // the record belongs to the main loop once it is queued
+  xQueueSend(this->done_queue_, &txn, portMAX_DELAY);
+  this->check_stuck_(error);
+}
+
+// A device that reboots mid-transfer can hold SDA low, after that every transfer fails until the bus is recovered.
+// Timeouts count, NACKs only while a line is held low (with both lines released it is just a missing device).
+void IDFI2CBus::check_stuck_(ErrorCode error) {
+  if (error == ERROR_OK) {
+    this->stuck_errors_ = 0;
+    return;
+  }
+  if (error == ERROR_NOT_ACKNOWLEDGED) {
+    if (gpio_get_level((gpio_num_t) sda_pin_) != 0 && gpio_get_level((gpio_num_t) scl_pin_) != 0)
+      return;
+  } else if (error != ERROR_TIMEOUT && error != ERROR_UNKNOWN) {
+    return;
+  }
+  if (++this->stuck_errors_ < I2C_STUCK_ERRORS)
+    return;
+  this->stuck_errors_ = 0;
+  this->recover_bus_();
+}
+
+// Runs on the worker, so the transaction queue waits meanwhile. The command link lock keeps the main loop's
+// blocking transfers off the bus while the driver is down. The watchdog is not fed from here (App belongs to the
+// main loop), the clock stretching waits of the recovery are bounded to a few ms.
+void IDFI2CBus::recover_bus_() {
+  ESP_LOGW(TAG, "Bus stuck, recovering");
+  xSemaphoreTake(this->cmd_link_lock_, portMAX_DELAY);
+  i2c_driver_delete(port_);
+  RecoveryCode result = this->recover_(false);
+  esp_err_t err = this->install_driver_();
+  xSemaphoreGive(this->cmd_link_lock_);
+  this->recovery_result_.store(result, std::memory_order_relaxed);
+  if (err != ESP_OK)
+    ESP_LOGE(TAG, "Driver reinstall after bus recovery failed, retrying after the next errors");
+  if (result == RECOVERY_COMPLETED && err == ESP_OK) {
+    this->recoveries_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    this->recovery_failures_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// Read phase of a split transaction, not before the device's turnaround passed.
+void IDFI2CBus::read_split_(I2CTransaction *txn, uint32_t due) {
+  int32_t left = (int32_t) (due - micros());
+  if (left > 0)
+    delayMicroseconds(left);
+  ReadBuffer buf{txn->read_data, txn->read_len};
+  txn->error = this->readv(txn->address, &buf, 1);
+  ESP_LOGVV(TAG, "0x%02X split transaction done: %d", txn->address, txn->error);
+  if (txn->error != ERROR_OK)
+    this->reprobe_turnaround_(txn->address);
+  this->complete_(txn);
+}
+
+// Turnaround to wait between the write and the read phase of a split transaction to the device. Adaptive: every
+// I2C_TURNAROUND_PROBE_INTERVAL transactions (and after a failed read) the device's turnaround is probed first.
+uint32_t IDFI2CBus::turnaround_(uint8_t address) {
+  if (!this->adaptive_turnaround_)
+    return this->split_turnaround_;
+  TurnaroundEstimate *slot = nullptr;
+  for (auto &estimate : this->turnaround_estimates_) {
+    if (estimate.address == address) {
+      slot = &estimate;
+      break;
+    }
+    if (estimate.address == 0 && slot == nullptr)
+      slot = &estimate;
+  }
+  if (slot == nullptr)
+    return this->split_turnaround_;  // more devices than slots, the others use the fixed turnaround
+  if (slot->address != address)
+    *slot = {address, 0, this->split_turnaround_};
+  if (slot->until_probe == 0) {
+    uint32_t sample = this->probe_turnaround_(address);
+    // no status within I2C_TURNAROUND_MAX_US: keep the last estimate, a failed read of the transaction itself
+    // probes again sooner (reprobe_turnaround_)
+    if (sample != 0)
+      slot->estimate_us = (slot->estimate_us * 3 + sample) / 4;
+    slot->until_probe = I2C_TURNAROUND_PROBE_INTERVAL;
+    ESP_LOGV(TAG, "0x%02X turnaround probed: %" PRIu32 "us, estimate %" PRIu32 "us", address, sample,
+             slot->estimate_us);
+  } else {
+    slot->until_probe--;
+  }
+  // some margin, the probe measures when the reply was there, not when it got there
+  return slot->estimate_us + slot->estimate_us / 4 + I2C_TURNAROUND_BACKOFF_MIN_US;
+}
+
+// Sends the link status command and reads until the device answers with its status word, retrying with an
+// exponential backoff. Returns the time (us) from the command until the read that got the status returned, 0 on
+// failure.
+uint32_t IDFI2CBus::probe_turnaround_(uint8_t address) {
+  uint8_t cmd = I2C_TURNAROUND_PROBE_CMD;
+  WriteBuffer write_buf{&cmd, 1};
+  if (this->writev(address, &write_buf, 1, true) != ERROR_OK)
+    return 0;
+  uint32_t start = micros();
+  uint32_t backoff = I2C_TURNAROUND_BACKOFF_MIN_US;
+  while (true) {
+    uint8_t status[4];
+    ReadBuffer read_buf{status, sizeof(status)};
+    ErrorCode err = this->readv(address, &read_buf, 1);
+    uint32_t elapsed = micros() - start;
+    if (err == ERROR_OK && status[0] == I2C_TURNAROUND_READY)
+      return std::max<uint32_t>(elapsed, 1);
+    if (elapsed >= I2C_TURNAROUND_MAX_US)
+      return 0;
+    delayMicroseconds(backoff);
+    backoff = std::min(backoff * 2, I2C_TURNAROUND_BACKOFF_MAX_US);
+  }
+}
+
+void IDFI2CBus::reprobe_turnaround_(uint8_t address) {
+  for (auto &estimate : this->turnaround_estimates_) {
+    if (estimate.address == address)
+      estimate.until_probe = 0;
+  }
+}
+
+// Bus worker: runs the submitted transactions one by one, so a slave that does not respond
+// blocks this task instead of the main loop. Only the worker owns the bus between transactions,
+// there is nothing a client has to take or give back.
+// Split transactions are pipelined: the command phases go out back to back and every response
+// is collected once its device's turnaround passed, instead of idling the bus for each device.
+void IDFI2CBus::worker_task_(void *arg) {
+  IDFI2CBus *bus = (IDFI2CBus *) arg;
+  I2CTransaction *txn = nullptr;
+  // split transactions whose write phase is done, waiting for their read phase
+  I2CTransaction *split[I2C_TXN_POOL_SIZE];
+  uint32_t split_due[I2C_TXN_POOL_SIZE];
+  size_t split_count = 0;
+  while (true) {
+    TickType_t wait = portMAX_DELAY;
+    if (split_count > 0) {
+      size_t first = 0;
+      for (size_t i = 1; i < split_count; i++) {
+        if ((int32_t) (split_due[i] - split_due[first]) < 0)
+          first = i;
+      }
+      int32_t left = (int32_t) (split_due[first] - micros());
+      if (left <= 0) {
+        // response due, collect it before the next command phase
+        bus->read_split_(split[first], split_due[first]);
+        split[first] = split[split_count - 1];
+        split_due[first] = split_due[split_count - 1];
+        split_count--;
+        continue;
+      }
+      // whole ticks only, a wait shorter than a tick is spun in read_split_()
+      wait = left / 1000 / portTICK_PERIOD_MS;
+      if (wait == 0 && uxSemaphoreGetCount(bus->txn_ready_) == 0) {
+        delayMicroseconds(left);
+        continue;
+      }
+    }
+    if (xSemaphoreTake(bus->txn_ready_, wait) != pdTRUE)
+      continue;
+    // highest priority class first, in submission order within a class
+    bool found = false;
+    for (auto &queue : bus->txn_queue_) {
+      if (xQueueReceive(queue, &txn, 0) == pdTRUE) {
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      continue;
+    // a device holds one response, collect an outstanding one before anything else goes to the device, split or
+    // not, or the next write would overwrite the response (and a plain read would get it instead of its own)
+    for (size_t i = 0; i < split_count; i++) {
+      if (split[i]->address != txn->address)
+        continue;
+      bus->read_split_(split[i], split_due[i]);
+      split[i] = split[split_count - 1];
+      split_due[i] = split_due[split_count - 1];
+      split_count--;
+      break;
+    }
+    if (bus->is_split_(*txn)) {
+      uint32_t turnaround = bus->turnaround_(txn->address);
+      WriteBuffer buf{txn->write_data, txn->write_len};
+      txn->error = bus->writev(txn->address, &buf, 1, true);
+      if (txn->error != ERROR_OK) {
+        bus->complete_(txn);
+        continue;
+      }
+      split[split_count] = txn;
+      split_due[split_count] = micros() + turnaround;
+      split_count++;
+      continue;
+    }
+#ifdef I2C_DEBUG_TIMING
+    uint64_t t0 = bus->timestamp();
+#endif // I2C_DEBUG_TIMING
+    bus->execute_(*txn);
+#ifdef I2C_DEBUG_TIMING
+    uint64_t t1 = bus->timestamp();
+    ESP_LOGVV(TAG, "[%lld : %7.3f ms] 0x%02X transaction done: %d", t1, (float)((t1 - t0) / 1000.0), txn->address, txn->error);
+#endif // I2C_DEBUG_TIMING
+    bus->complete_(txn);
+  }
+  vTaskDelete(NULL);
+}
+
+// Command links are built in the bus' static buffer instead of the heap, the lock is held
+// from creation until the link is deleted.
+i2c_cmd_handle_t IDFI2CBus::cmd_link_create_() {
+  xSemaphoreTake(this->cmd_link_lock_, portMAX_DELAY);
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(this->cmd_link_buf_, sizeof(this->cmd_link_buf_));
+  if (cmd == nullptr)
+    xSemaphoreGive(this->cmd_link_lock_);
+  return cmd;
+}
+
+void IDFI2CBus::cmd_link_delete_(i2c_cmd_handle_t cmd) {
+  i2c_cmd_link_delete_static(cmd);
+  xSemaphoreGive(this->cmd_link_lock_);
+}
+
 ErrorCode IDFI2CBus::readv(uint8_t address, ReadBuffer *buffers, size_t cnt) {
   // logging is only enabled with vv level, if warnings are shown the caller
   // should log them
@@ -151,17 +456,21 @@ ErrorCode IDFI2CBus::readv(uint8_t address, ReadBuffer *buffers, size_t cnt) {
     ESP_LOGVV(TAG, "i2c bus not initialized!");
     return ERROR_NOT_INITIALIZED;
   }
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  i2c_cmd_handle_t cmd = this->cmd_link_create_();
+  if (cmd == nullptr) {
+    ESP_LOGVV(TAG, "%02X command link creation failed", address);
+    return ERROR_UNKNOWN;
+  }
   esp_err_t err = i2c_master_start(cmd);
   if (err != ESP_OK) {
     ESP_LOGVV(TAG, "RX from %02X master start failed: %s", address, esp_err_to_name(err));
-    i2c_cmd_link_delete(cmd);
+    this->cmd_link_delete_(cmd);
     return ERROR_UNKNOWN;
   }
   err = i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_READ, true);
   if (err != ESP_OK) {
     ESP_LOGVV(TAG, "RX from %02X address write failed: %s", address, esp_err_to_name(err));
-    i2c_cmd_link_delete(cmd);
+    this->cmd_link_delete_(cmd);
     return ERROR_UNKNOWN;
   }
   for (size_t i = 0; i < cnt; i++) {
@@ -171,20 +480,20 @@ ErrorCode IDFI2CBus::readv(uint8_t address, ReadBuffer *buffers, size_t cnt) {
     err = i2c_master_read(cmd, buf.data, buf.len, i == cnt - 1 ? I2C_MASTER_LAST_NACK : I2C_MASTER_ACK);
     if (err != ESP_OK) {
       ESP_LOGVV(TAG, "RX from %02X data read failed: %s", address, esp_err_to_name(err));
-      i2c_cmd_link_delete(cmd);
+      this->cmd_link_delete_(cmd);
       return ERROR_UNKNOWN;
     }
   }
   err = i2c_master_stop(cmd);
   if (err != ESP_OK) {
     ESP_LOGVV(TAG, "RX from %02X stop failed: %s", address, esp_err_to_name(err));
-    i2c_cmd_link_delete(cmd);
+    this->cmd_link_delete_(cmd);
     return ERROR_UNKNOWN;
   }
   err = i2c_master_cmd_begin(port_, cmd, 20 / portTICK_PERIOD_MS);
   // i2c_master_cmd_begin() will block for a whole second if no ack:
   // https://github.com/espressif/esp-idf/issues/4999
-  i2c_cmd_link_delete(cmd);
+  this->cmd_link_delete_(cmd);
   if (err == ESP_FAIL) {
     // transfer not acked
     ESP_LOGVV(TAG, "RX from %02X failed: not acked", address);
@@ -235,17 +544,21 @@ ErrorCode IDFI2CBus::writev(uint8_t address, WriteBuffer *buffers, size_t cnt, b
   ESP_LOGVV(TAG, "0x%02X TX %s", address, debug_hex.c_str());
 #endif
 
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  i2c_cmd_handle_t cmd = this->cmd_link_create_();
+  if (cmd == nullptr) {
+    ESP_LOGVV(TAG, "%02X command link creation failed", address);
+    return ERROR_UNKNOWN;
+  }
   esp_err_t err = i2c_master_start(cmd);
   if (err != ESP_OK) {
     ESP_LOGVV(TAG, "TX to %02X master start failed: %s", address, esp_err_to_name(err));
-    i2c_cmd_link_delete(cmd);
+    this->cmd_link_delete_(cmd);
     return ERROR_UNKNOWN;
   }
   err = i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
   if (err != ESP_OK) {
     ESP_LOGVV(TAG, "TX to %02X address write failed: %s", address, esp_err_to_name(err));
-    i2c_cmd_link_delete(cmd);
+    this->cmd_link_delete_(cmd);
     return ERROR_UNKNOWN;
   }
   for (size_t i = 0; i < cnt; i++) {
@@ -255,7 +568,7 @@ ErrorCode IDFI2CBus::writev(uint8_t address, WriteBuffer *buffers, size_t cnt, b
     err = i2c_master_write(cmd, buf.data, buf.len, true);
     if (err != ESP_OK) {
       ESP_LOGVV(TAG, "TX to %02X data write failed: %s", address, esp_err_to_name(err));
-      i2c_cmd_link_delete(cmd);
+      this->cmd_link_delete_(cmd);
       return ERROR_UNKNOWN;
     }
   }
@@ -263,12 +576,12 @@ ErrorCode IDFI2CBus::writev(uint8_t address, WriteBuffer *buffers, size_t cnt, b
     err = i2c_master_stop(cmd);
     if (err != ESP_OK) {
       ESP_LOGVV(TAG, "TX to %02X master stop failed: %s", address, esp_err_to_name(err));
-      i2c_cmd_link_delete(cmd);
+      this->cmd_link_delete_(cmd);
       return ERROR_UNKNOWN;
     }
   }
   err = i2c_master_cmd_begin(port_, cmd, 20 / portTICK_PERIOD_MS);
-  i2c_cmd_link_delete(cmd);
+  this->cmd_link_delete_(cmd);
   if (err == ESP_FAIL) {
     // transfer not acked
     ESP_LOGVV(TAG, "TX to %02X failed: not acked", address);
@@ -283,10 +596,63 @@ ErrorCode IDFI2CBus::writev(uint8_t address, WriteBuffer *buffers, size_t cnt, b
   return ERROR_OK;
 }
 
+ErrorCode IDFI2CBus::write_readv(uint8_t address, const uint8_t *write_data, size_t write_len, ReadBuffer *buffers,
+                                 size_t cnt) {
+  // logging is only enabled with vv level, if warnings are shown the caller
+  // should log them
+  if (!initialized_) {
+    ESP_LOGVV(TAG, "i2c bus not initialized!");
+    return ERROR_NOT_INITIALIZED;
+  }
+  // START, address+W, data, repeated START, address+R, data, STOP - all in one command link
+  i2c_cmd_handle_t cmd = this->cmd_link_create_();
+  if (cmd == nullptr) {
+    ESP_LOGVV(TAG, "%02X command link creation failed", address);
+    return ERROR_UNKNOWN;
+  }
+  esp_err_t err = i2c_master_start(cmd);
+  if (err == ESP_OK)
+    err = i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+  if (err == ESP_OK && write_len > 0)
+    err = i2c_master_write(cmd, write_data, write_len, true);
+  if (err == ESP_OK)
+    err = i2c_master_start(cmd);
+  if (err == ESP_OK)
+    err = i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_READ, true);
+  for (size_t i = 0; err == ESP_OK && i < cnt; i++) {
+    const auto &buf = buffers[i];
+    if (buf.len == 0)
+      continue;
+    err = i2c_master_read(cmd, buf.data, buf.len, i == cnt - 1 ? I2C_MASTER_LAST_NACK : I2C_MASTER_ACK);
+  }
+  if (err == ESP_OK)
+    err = i2c_master_stop(cmd);
+  if (err != ESP_OK) {
+    ESP_LOGVV(TAG, "TX/RX %02X command link failed: %s", address, esp_err_to_name(err));
+    this->cmd_link_delete_(cmd);
+    return ERROR_UNKNOWN;
+  }
+  err = i2c_master_cmd_begin(port_, cmd, 20 / portTICK_PERIOD_MS);
+  this->cmd_link_delete_(cmd);
+  if (err == ESP_FAIL) {
+    // transfer not acked
+    ESP_LOGVV(TAG, "TX/RX %02X failed: not acked", address);
+    return ERROR_NOT_ACKNOWLEDGED;
+  } else if (err == ESP_ERR_TIMEOUT) {
+    ESP_LOGVV(TAG, "TX/RX %02X failed: timeout", address);
+    return ERROR_TIMEOUT;
+  } else if (err != ESP_OK) {
+    ESP_LOGVV(TAG, "TX/RX %02X failed: %s", address, esp_err_to_name(err));
+    return ERROR_UNKNOWN;
+  }
+  return ERROR_OK;
+}
+
 /// Perform I2C bus recovery, see:
 /// https://www.nxp.com/docs/en/user-guide/UM10204.pdf
 /// https://www.analog.com/media/en/technical-documentation/application-notes/54305147357414AN686_0.pdf
-void IDFI2CBus::recover_() {
+/// feed_wdt: feed the watchdog while waiting for a stretched clock, only allowed on the main loop
+RecoveryCode IDFI2CBus::recover_(bool feed_wdt) {
   ESP_LOGI(TAG, "Performing bus recovery");
 
   const gpio_num_t scl_pin = static_cast<gpio_num_t>(scl_pin_);
@@ -325,8 +691,7 @@ void IDFI2CBus::recover_() {
   delayMicroseconds(half_period_usec);
   if (gpio_get_level(scl_pin) == 0) {
     ESP_LOGE(TAG, "Recovery failed: SCL is held LOW on the bus");
-    recovery_result_ = RECOVERY_FAILED_SCL_LOW;
-    return;
+    return RECOVERY_FAILED_SCL_LOW;
   }
 
   // From the specification:
@@ -351,13 +716,13 @@ void IDFI2CBus::recover_() {
     // all.
     auto wait = 250;
     while (wait-- && gpio_get_level(scl_pin) == 0) {
-      App.feed_wdt();
+      if (feed_wdt)
+        App.feed_wdt();
       delayMicroseconds(half_period_usec * 2);
     }
     if (gpio_get_level(scl_pin) == 0) {
       ESP_LOGE(TAG, "Recovery failed: SCL is held LOW during clock pulse cycle");
-      recovery_result_ = RECOVERY_FAILED_SCL_LOW;
-      return;
+      return RECOVERY_FAILED_SCL_LOW;
     }
   }
 
@@ -366,8 +731,7 @@ void IDFI2CBus::recover_() {
   // in SDA being pulled up.
   if (gpio_get_level(sda_pin) == 0) {
     ESP_LOGE(TAG, "Recovery failed: SDA is held LOW after clock pulse cycle");
-    recovery_result_ = RECOVERY_FAILED_SDA_LOW;
-    return;
+    return RECOVERY_FAILED_SDA_LOW;
   }
 
   // From the specification:
@@ -393,7 +757,7 @@ void IDFI2CBus::recover_() {
   delayMicroseconds(half_period_usec);
   gpio_set_level(sda_pin, 1);
 
-  recovery_result_ = RECOVERY_COMPLETED;
+  return RECOVERY_COMPLETED;
 }
 
 }  // namespace i2c
@@ -5,12 +5,15 @@
 #include "i2c_bus.h"
 #include "esphome/core/component.h"
 #include <driver/i2c.h>
+#include <atomic>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/queue.h>
 
-#ifndef I2C_DEBUG_TIMING // MAX 2 GPTIMERS GLOBALLY, OTHERWISE NOT BOOTING
-#define I2C_DEBUG_TIMING
+// Transaction timing logs, enable with build flag -DI2C_DEBUG_TIMING
+// (uses a GPTIMER, MAX 2 GPTIMERS GLOBALLY, OTHERWISE NOT BOOTING)
+#ifdef I2C_DEBUG_TIMING
 #include "driver/gptimer.h"
 #endif // I2C_DEBUG_TIMING
 
@@ -23,7 +26,53 @@ enum RecoveryCode {
   RECOVERY_COMPLETED,
 };
 
-static const int SEMAPHORE_TIMEOUT = 5; // ms
+/// @brief priority classes of asynchronous transactions, a lower value runs first
+enum TransactionPriority : uint8_t {
+  PRIORITY_COMMAND = 0,  ///< commands (f.e. switching), go ahead of polls
+  PRIORITY_POLL = 1,     ///< background polling of sensors/states
+  PRIORITY_COUNT,
+};
+
+static const size_t I2C_TXN_MAX_WRITE = 12;  ///< max bytes written by an asynchronous transaction (key + widest register)
+static const size_t I2C_TXN_MAX_READ = 64;   ///< max bytes read by an asynchronous transaction
+static const size_t I2C_TXN_POOL_SIZE = 16;  ///< max number of acquired, not yet completed transactions per bus
+/// @brief adaptive split turnaround, see IDFI2CBus::set_adaptive_turnaround()
+static const uint8_t I2C_TURNAROUND_PROBE_CMD = 0xF4;       ///< status command of the i2c_slave link
+static const uint8_t I2C_TURNAROUND_READY = 0xA5;           ///< first byte of the status reply once it is prepared
+static const size_t I2C_TURNAROUND_SLOTS = 16;              ///< max number of devices with a measured turnaround
+static const uint16_t I2C_TURNAROUND_PROBE_INTERVAL = 64;   ///< split transactions of a device between two probes
+static const uint32_t I2C_TURNAROUND_BACKOFF_MIN_US = 25;   ///< first retry of a probe read, doubled per retry
+static const uint32_t I2C_TURNAROUND_BACKOFF_MAX_US = 1000;
+static const uint32_t I2C_TURNAROUND_MAX_US = 20000;        ///< a probe gives up after this, the last estimate is kept
+
+/// @brief consecutive timeouts (or NACKs with SDA/SCL held low) after which the worker recovers the bus
+static const uint8_t I2C_STUCK_ERRORS = 8;
+
+/// @brief size of the static command link buffer, enough for the largest transaction (write, repeated start, read)
+static const size_t I2C_CMD_LINK_SIZE = I2C_LINK_RECOMMENDED_SIZE(4);
+
+struct I2CTransaction;
+
+/// @brief callback for a completed asynchronous transaction, called on the main loop
+typedef void (*i2c_txn_callback_t)(const I2CTransaction &txn);
+
+/// @brief descriptor of an asynchronous bus transaction: a write, followed by a read after a repeated start if
+/// read_len > 0. Without write data only the read is done.
+/// @note Transactions are records of a fixed per-bus pool, see IDFI2CBus::acquire(), they are never allocated or
+/// copied while polling.
+struct I2CTransaction {
+  uint8_t address;                          ///< address of the device on the bus
+  uint8_t write_len;                        ///< number of bytes in write_data
+  uint8_t read_len;                         ///< number of bytes to read into read_data
+  TransactionPriority priority;             ///< priority class, transactions of the same class run in order
+  uint8_t write_data[I2C_TXN_MAX_WRITE];    ///< bytes to write (f.e. registry key or command)
+  uint8_t read_data[I2C_TXN_MAX_READ];      ///< bytes read, valid in the callback if error == ERROR_OK
+  ErrorCode error;                          ///< result of the transaction, set by the bus worker
+  i2c_txn_callback_t callback;              ///< called on the main loop when the transaction completed (optional)
+  void *arg;                                ///< pointer to the submitting object, passed on to the callback
+  uint32_t tag;                             ///< free to use by the submitter
+  I2CTransaction *next_free;                ///< link in the pool's free list, owned by the bus
+};
 
 class IDFI2CBus : public I2CBus, public Component {
  public:
@@ -31,8 +80,23 @@ class IDFI2CBus : public I2CBus, public Component {
   void dump_config() override;
   ErrorCode readv(uint8_t address, ReadBuffer *buffers, size_t cnt) override;
   ErrorCode writev(uint8_t address, WriteBuffer *buffers, size_t cnt, bool stop) override;
+  ErrorCode write_readv(uint8_t address, const uint8_t *write_data, size_t write_len, ReadBuffer *buffers,
+                        size_t cnt) override;
+  void loop() override;
   float get_setup_priority() const override { return setup_priority::BUS; }
 
+  /// @brief take a cleared transaction record from the bus' pool, to be filled in and submitted (main loop only)
+  /// @return nullptr if the bus is not initialized or all records are in use
+  I2CTransaction *acquire();
+
+  /// @brief queue an acquired transaction for the bus worker task, the main loop never blocks on the bus
+  /// @details the worker always runs the oldest transaction of the highest priority class next, the bus is owned
+  /// by the worker for the duration of one transaction only. The record returns to the pool after its callback.
+  /// With a split turnaround a write + read transaction is split in two: the write ends with a STOP, the read
+  /// follows once the turnaround passed, in between the worker serves other devices.
+  /// @return false (and the record is returned to the pool) if the transaction is too large
+  bool submit(I2CTransaction *txn);
+
   void set_scan(bool scan) { scan_ = scan; }
   void set_sda_pin(uint8_t sda_pin) { sda_pin_ = sda_pin; }
   void set_sda_pullup_enabled(bool sda_pullup_enabled) { sda_pullup_enabled_ = sda_pullup_enabled; }
@@ -40,26 +104,72 @@ class IDFI2CBus : public I2CBus, public Component {
   void set_scl_pullup_enabled(bool scl_pullup_enabled) { scl_pullup_enabled_ = scl_pullup_enabled; }
   void set_frequency(uint32_t frequency) { frequency_ = frequency; }
   void set_timeout(uint32_t timeout) { timeout_ = timeout; }
+  /// @brief time (us) a device needs between the write and the read of a transaction, 0: no split transactions
+  void set_split_turnaround(uint32_t split_turnaround) { split_turnaround_ = split_turnaround; }
+  /// @brief measure the turnaround of every device (i2c_slave link status command) instead of using the fixed
+  /// split turnaround, which becomes the starting value
+  void set_adaptive_turnaround(bool adaptive_turnaround) { adaptive_turnaround_ = adaptive_turnaround; }
 
-  SemaphoreHandle_t semaphore_;
+  /// @brief number of successful runtime bus recoveries (stuck bus detected by the worker) since boot
+  uint32_t get_recovery_count() const { return recoveries_.load(std::memory_order_relaxed); }
+  /// @brief number of runtime bus recoveries that left a line held low or failed to reinstall the driver
+  uint32_t get_recovery_failure_count() const { return recovery_failures_.load(std::memory_order_relaxed); }
 
 #ifdef I2C_DEBUG_TIMING
   uint64_t timestamp();
 #endif // I2C_DEBUG_TIMING
 
  private:
-  void recover_();
-  RecoveryCode recovery_result_;
+  RecoveryCode recover_(bool feed_wdt);
+  esp_err_t install_driver_();
+  void check_stuck_(ErrorCode error);
+  void recover_bus_();
+  static void worker_task_(void *arg);
+  void execute_(I2CTransaction &txn);
+  bool is_split_(const I2CTransaction &txn) const {
+    return split_turnaround_ > 0 && txn.write_len > 0 && txn.read_len > 0;
+  }
+  void read_split_(I2CTransaction *txn, uint32_t due);
+  uint32_t turnaround_(uint8_t address);
+  uint32_t probe_turnaround_(uint8_t address);
+  void reprobe_turnaround_(uint8_t address);
+  void complete_(I2CTransaction *txn);
+  void release_(I2CTransaction *txn);
+  i2c_cmd_handle_t cmd_link_create_();
+  void cmd_link_delete_(i2c_cmd_handle_t cmd);
+  std::atomic<RecoveryCode> recovery_result_{RECOVERY_COMPLETED};  ///< last recovery, written by setup() and the worker
 
  protected:
-  i2c_port_t port_;
+  i2c_port_t port_{I2C_NUM_MAX};  ///< I2C_NUM_MAX until setup() claimed a port
   uint8_t sda_pin_;
   bool sda_pullup_enabled_;
   uint8_t scl_pin_;
   bool scl_pullup_enabled_;
   uint32_t frequency_;
   uint32_t timeout_ = 0;
+  uint32_t split_turnaround_ = 0;
+  bool adaptive_turnaround_ = false;
+  uint8_t stuck_errors_ = 0;                 ///< consecutive errors that hint at a stuck bus, only used by the worker
+  std::atomic<uint32_t> recoveries_{0};      ///< successful runtime recoveries, counted by the worker
+  std::atomic<uint32_t> recovery_failures_{0};  ///< failed runtime recoveries, counted by the worker
+  uint32_t recoveries_logged_ = 0;
+  uint32_t recovery_failures_logged_ = 0;
+  /// @brief measured turnaround of a device, only used by the worker
+  struct TurnaroundEstimate {
+    uint8_t address;        ///< 0: free slot
+    uint16_t until_probe;   ///< split transactions until the next probe, 0: probe before the next one
+    uint32_t estimate_us;   ///< moving average of the probed turnarounds
+  };
+  TurnaroundEstimate turnaround_estimates_[I2C_TURNAROUND_SLOTS]{};
   bool initialized_ = false;
+  I2CTransaction txn_pool_[I2C_TXN_POOL_SIZE]{};  ///< preallocated transaction records
+  I2CTransaction *txn_free_{nullptr};             ///< free list of txn_pool_, only used on the main loop
+  QueueHandle_t txn_queue_[PRIORITY_COUNT]{};     ///< submitted transactions per priority class, consumed by the worker
+  SemaphoreHandle_t txn_ready_{nullptr};          ///< counts the submitted transactions over all priority classes
+  QueueHandle_t done_queue_{nullptr};             ///< completed transactions, consumed by loop()
+  alignas(4) uint8_t cmd_link_buf_[I2C_CMD_LINK_SIZE];  ///< static command link buffer, shared by all transfers
+  StaticSemaphore_t cmd_link_lock_buf_;
+  SemaphoreHandle_t cmd_link_lock_{nullptr};      ///< serializes the use of cmd_link_buf_ (worker and main loop)
 
 #ifdef I2C_DEBUG_TIMING
   gptimer_handle_t gptimer = NULL;
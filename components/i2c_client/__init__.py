@@ -0,0 +1,59 @@
+from esphome import pins
+import esphome.codegen as cg
+from esphome.components import i2c
+import esphome.config_validation as cv
+from esphome.const import CONF_ID
+from esphome.components.i2c_link import (  # noqa: F401, the register types and keys are shared with i2c_slave
+    CONF_REGISTER_TYPE,
+    I2C_REG_KEY_MAX,
+    REGISTER_TYPES,
+    RegisterType,
+    i2c_registry_key,
+    register_type_schema,
+)
+
+DEPENDENCIES = ["i2c"] # client depends on i2c master (extends I2CDevice)
+MULTI_CONF = True
+AUTO_LOAD = ["i2c_link"]
+
+CONF_I2C_CLIENT_ID = "i2c_client_id"
+CONF_READ_CHANGED_ONLY = "read_changed_only"
+CONF_ALERT_PIN = "alert_pin"
+
+i2c_client_ns = cg.esphome_ns.namespace("i2c_client")
+I2CClientComponent = i2c_client_ns.class_("I2CClientComponent", cg.PollingComponent, i2c.I2CDevice)
+
+
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(I2CClientComponent),
+            cv.Optional(CONF_READ_CHANGED_ONLY, default=False): cv.boolean,
+            cv.Optional(CONF_ALERT_PIN): pins.internal_gpio_input_pin_schema,
+        }
+    )
+    .extend(cv.polling_component_schema("10s"))
+    .extend(i2c.i2c_device_schema(None))
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await i2c.register_i2c_device(var, config)
+    # the slave releases its alert line on a dirty read, so the hub must read the bitmap when it listens to it
+    cg.add(var.set_read_changed_only(config[CONF_READ_CHANGED_ONLY] or CONF_ALERT_PIN in config))
+    if CONF_ALERT_PIN in config:
+        alert_pin = await cg.gpio_pin_expression(config[CONF_ALERT_PIN])
+        cg.add(var.set_alert_pin(alert_pin))
+
+
+def i2c_client_hub_schema():
+    """Create a schema for a sensor/switch that can be polled by an i2c_client hub.
+
+    :return: The i2c client hub schema, `extend` this in your config schema.
+    """
+    schema = {
+        cv.Optional(CONF_I2C_CLIENT_ID): cv.use_id(I2CClientComponent),
+    }
+    return cv.Schema(schema)
@@ -0,0 +1,52 @@
+import esphome.codegen as cg
+from esphome.components import i2c, i2c_client, i2c_link, binary_sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ID,
+)
+
+DEPENDENCIES = ["i2c"] # client depends on i2c master (extends I2CDevice)
+
+CONF_I2C_REG_KEY = "i2c_registry_key"
+
+i2c_client_ns = cg.esphome_ns.namespace("i2c_client")
+I2CClientBinarySensor = i2c_client_ns.class_("I2CClientBinarySensor", cg.PollingComponent, i2c.I2CDevice)
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(I2CClientBinarySensor),
+            cv.Required(CONF_I2C_REG_KEY): i2c_client.i2c_registry_key,
+            cv.Optional(i2c_client.CONF_REGISTER_TYPE, default="u8"): cv.one_of(*i2c_link.REGISTER_TYPE_BITS, lower=True),
+            cv.Required(i2c_link.CONF_BINARY_SENSORS): cv.ensure_list(
+                binary_sensor.binary_sensor_schema().extend(
+                    {
+                        cv.Required(i2c_link.CONF_BIT): cv.int_range(min=0, max=31),
+                    }
+                )
+            ),
+        }
+    )
+    .extend(cv.polling_component_schema("10s"))
+    .extend(i2c.i2c_device_schema(0x0))
+    .extend(i2c_client.i2c_client_hub_schema()),
+    i2c_link.validate_bits,
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await i2c.register_i2c_device(var, config)
+
+    cg.add(var.set_registry_key(config[CONF_I2C_REG_KEY]))
+    cg.add(var.set_register_type(i2c_client.REGISTER_TYPES[config[i2c_client.CONF_REGISTER_TYPE]]))
+
+    if i2c_client.CONF_I2C_CLIENT_ID in config:
+        hub = await cg.get_variable(config[i2c_client.CONF_I2C_CLIENT_ID])
+        cg.add(hub.register_binary_sensor(var))
+
+    for conf in config[i2c_link.CONF_BINARY_SENSORS]:
+        sens = await binary_sensor.new_binary_sensor(conf)
+        cg.add(var.add_binary_sensor(sens, conf[i2c_link.CONF_BIT]))
@@ -0,0 +1,274 @@
+#include "i2c_client.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "../i2c/i2c_bus_esp_idf.h"
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace i2c_client {
+
+static const char *const TAG = "i2c_client";
+
+DeviceHealth *DeviceHealth::get(i2c::I2CBus *bus, uint8_t address) {
+  static std::vector<DeviceHealth *> devices;
+  for (auto *device : devices) {
+    if (device->bus_ == bus && device->address_ == address)
+      return device;
+  }
+  auto *device = new DeviceHealth(bus, address);  // NOLINT(cppcoreguidelines-owning-memory), lives forever
+  devices.push_back(device);
+  return device;
+}
+
+bool DeviceHealth::allow_poll() {
+  HealthBreaker::State before = this->breaker_.get_state();
+  if (!this->breaker_.allow_poll(millis()))
+    return false;
+  if (before != HealthBreaker::STATE_UP)
+    ESP_LOGV(TAG, "Probing slave 0x%02X", this->address_);
+  return true;
+}
+
+void DeviceHealth::record(i2c::ErrorCode error) {
+  HealthBreaker::State before = this->breaker_.get_state();
+  this->breaker_.record(error == i2c::ERROR_OK, millis());
+  HealthBreaker::State after = this->breaker_.get_state();
+  if (after == HealthBreaker::STATE_UP) {
+    if (before != HealthBreaker::STATE_UP)
+      ESP_LOGI(TAG, "Slave 0x%02X is responding again", this->address_);
+    return;
+  }
+  if (before == HealthBreaker::STATE_UP && after == HealthBreaker::STATE_DOWN)
+    ESP_LOGW(TAG, "Slave 0x%02X not responding (error %d), skipping its polls", this->address_, error);
+  if (before != HealthBreaker::STATE_DOWN && after == HealthBreaker::STATE_DOWN)
+    ESP_LOGV(TAG, "Slave 0x%02X down, next probe in %u ms", this->address_, (unsigned) this->breaker_.get_backoff_ms());
+}
+
+void I2CClientComponent::register_sensor(I2CClientSensor *sensor) {
+  sensor->set_update_interval(SCHEDULER_DONT_RUN);
+  this->sensors_.push_back(sensor);
+  this->registers_.push_back(sensor);
+}
+
+void I2CClientComponent::register_switch(I2CClientSwitch *sw) {
+  sw->set_update_interval(SCHEDULER_DONT_RUN);
+  this->switches_.push_back(sw);
+  this->registers_.push_back(sw);
+}
+
+#ifdef USE_BINARY_SENSOR
+void I2CClientComponent::register_binary_sensor(I2CClientBinarySensor *binary_sensor) {
+  binary_sensor->set_update_interval(SCHEDULER_DONT_RUN);
+  this->binary_sensors_.push_back(binary_sensor);
+  this->registers_.push_back(binary_sensor);
+}
+#endif  // USE_BINARY_SENSOR
+
+void I2CClientComponent::setup() {
+  ESP_LOGCONFIG(TAG, "Running setup");
+
+  // children talk to the hub's slave, the hub is set up before them
+  for (auto *sensor : this->sensors_) {
+    sensor->set_i2c_bus(this->bus_);
+    sensor->set_i2c_address(this->address_);
+  }
+  for (auto *sw : this->switches_) {
+    sw->set_i2c_bus(this->bus_);
+    sw->set_i2c_address(this->address_);
+  }
+#ifdef USE_BINARY_SENSOR
+  for (auto *binary_sensor : this->binary_sensors_) {
+    binary_sensor->set_i2c_bus(this->bus_);
+    binary_sensor->set_i2c_address(this->address_);
+  }
+#endif  // USE_BINARY_SENSOR
+
+  if (this->alert_pin_ != nullptr) {
+    this->alert_pin_->setup();
+    this->alert_pin_->attach_interrupt(alert_isr_, this, gpio::INTERRUPT_FALLING_EDGE);
+  }
+
+  std::sort(this->registers_.begin(), this->registers_.end(),
+            [](I2CClientRegister *a, I2CClientRegister *b) { return a->get_registry_key() < b->get_registry_key(); });
+
+  ESP_LOGV(TAG, "Initialization complete");
+}
+
+void IRAM_ATTR I2CClientComponent::alert_isr_(I2CClientComponent *arg) { arg->alert_.on_edge(); }
+
+void I2CClientComponent::loop() {
+  // the slave signalled a change: read it now instead of waiting for the next scheduled update (see AlertTrigger)
+  if (this->pending_ == 0 && this->alert_pin_ != nullptr && this->alert_.poll(!this->alert_pin_->digital_read())) {
+    ESP_LOGV(TAG, "Alert from slave, updating");
+    this->update();
+  }
+}
+
+void I2CClientComponent::update() {
+  esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
+
+  if (this->pending_ > 0) {
+    ESP_LOGV(TAG, "Previous update still pending (%u requests)", this->pending_);
+    return;
+  }
+  if (this->health_ == nullptr)
+    this->health_ = DeviceHealth::get(this->bus_, this->address_);
+  if (!this->health_->allow_poll()) {
+    ESP_LOGVV(TAG, "Slave 0x%02X down, update skipped", this->address_);
+    this->resync_ = true;  // it may have restarted
+    return;
+  }
+  this->update_failed_ = false;
+
+  if (this->read_changed_only_) {
+    // fetch the dirty bitmap first, the burst reads of the changed registers are queued when it arrives
+    i2c::I2CTransaction *txn = bus->acquire();
+    if (txn == nullptr) {
+      ESP_LOGV(TAG, "No free bus transaction for the dirty bitmap");
+      this->update_failed_ = true;
+    } else {
+      txn->address = this->address_;
+      txn->write_data[0] = I2C_CMD_DIRTY_READ;
+      txn->write_len = 1;
+      txn->read_len = I2C_DIRTY_BITMAP_SIZE;
+      txn->priority = i2c::PRIORITY_POLL;
+      txn->callback = on_dirty_done_;
+      txn->arg = this;
+      if (bus->submit(txn)) {
+        this->pending_++;
+      } else {
+        ESP_LOGV(TAG, "Failed to queue dirty bitmap read");
+        this->update_failed_ = true;
+      }
+    }
+  } else {
+    this->queue_burst_reads_(nullptr);
+  }
+  if (this->pending_ == 0)
+    this->update_done_();
+}
+
+// queue burst reads for all registers, or only the ones flagged in the dirty bitmap
+void I2CClientComponent::queue_burst_reads_(const uint8_t *dirty) {
+  esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
+  auto is_dirty = [dirty](uint8_t key) { return dirty == nullptr || ((dirty[key >> 3] >> (key & 7)) & 1); };
+
+  size_t i = 0;
+  while (i < this->registers_.size()) {
+    uint8_t start_key = this->registers_[i]->get_registry_key();
+    if (!is_dirty(start_key)) {
+      i++;
+      continue;
+    }
+    // collect a run of consecutive (dirty) registry keys
+    uint8_t count = 1;
+    // registers are sent with the size of their type, a burst is limited by the transaction's read buffer
+    size_t read_len = this->registers_[i]->get_register_size();
+    while (i + count < this->registers_.size() &&
+           read_len + this->registers_[i + count]->get_register_size() <= i2c::I2C_TXN_MAX_READ &&
+           this->registers_[i + count]->get_registry_key() == start_key + count && is_dirty(start_key + count)) {
+      read_len += this->registers_[i + count]->get_register_size();
+      count++;
+    }
+
+    // burst read of the run, in one transaction run by the bus worker
+    i2c::I2CTransaction *txn = bus->acquire();
+    if (txn == nullptr) {
+      ESP_LOGV(TAG, "No free bus transaction for 0x%02X..0x%02X", start_key, start_key + count - 1);
+      this->update_failed_ = true;
+      i += count;
+      continue;
+    }
+    txn->address = this->address_;
+    txn->write_data[0] = I2C_CMD_BURST_READ;
+    txn->write_data[1] = start_key;
+    txn->write_data[2] = count;
+    txn->write_len = 3;
+    txn->read_len = read_len;
+    txn->priority = i2c::PRIORITY_POLL;
+    txn->callback = on_burst_done_;
+    txn->arg = this;
+    txn->tag = i; // index of the first register of the run
+    if (bus->submit(txn)) {
+      this->pending_++;
+    } else {
+      ESP_LOGV(TAG, "Failed to queue burst read of 0x%02X..0x%02X", start_key, start_key + count - 1);
+      this->update_failed_ = true;
+    }
+    i += count;
+  }
+}
+
+// static class member function, called on the main loop when the dirty bitmap has been read
+void I2CClientComponent::on_dirty_done_(const i2c::I2CTransaction &txn) {
+  I2CClientComponent *this_ = (I2CClientComponent *)txn.arg;
+  this_->pending_--;
+  this_->last_error_ = txn.error;
+  this_->health_->record(txn.error);
+
+  bool changed = false;
+  if (txn.error == i2c::ERROR_OK)
+    changed = std::any_of(txn.read_data, txn.read_data + I2C_DIRTY_BITMAP_SIZE, [](uint8_t bits) { return bits != 0; });
+  this_->alert_.on_dirty_read(changed);
+
+  if (txn.error != i2c::ERROR_OK) {
+    ESP_LOGV(TAG, "Dirty bitmap read failed: %d", txn.error);
+    this_->update_failed_ = true;
+  } else {
+    // the bitmap is read on a resync as well, so it is cleared (and the alert line released) every update
+    this_->queue_burst_reads_(this_->resync_ ? nullptr : txn.read_data);
+    this_->resync_ = false;
+  }
+  if (this_->pending_ == 0)
+    this_->update_done_();
+}
+
+// static class member function, called on the main loop when a burst read completed
+void I2CClientComponent::on_burst_done_(const i2c::I2CTransaction &txn) {
+  I2CClientComponent *this_ = (I2CClientComponent *)txn.arg;
+  this_->pending_--;
+  this_->last_error_ = txn.error;
+  this_->health_->record(txn.error);
+
+  uint8_t count = txn.write_data[2];
+  if (txn.error != i2c::ERROR_OK) {
+    ESP_LOGV(TAG, "Burst read of 0x%02X..0x%02X failed: %d", txn.write_data[1], txn.write_data[1] + count - 1, txn.error);
+    this_->update_failed_ = true;
+  } else {
+    size_t offset = 0;
+    for (uint8_t n = 0; n < count; n++) {
+      I2CClientRegister *reg = this_->registers_[txn.tag + n];
+      value_t val{};
+      memcpy(val.value_raw, txn.read_data + offset, reg->get_register_size());
+      offset += reg->get_register_size();
+      reg->publish_value(val);
+    }
+  }
+  if (this_->pending_ == 0)
+    this_->update_done_();
+}
+
+void I2CClientComponent::update_done_() {
+  if (this->update_failed_) {
+    // the slave cleared its dirty bitmap, but not every change may have arrived: read everything next time
+    this->resync_ = true;
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("Register read failed");
+  } else {
+    this->status_clear_warning();
+  }
+}
+
+void I2CClientComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "I2C Client Hub:");
+  LOG_I2C_DEVICE(this);
+  ESP_LOGCONFIG(TAG, "  Registers: %u", (unsigned) this->registers_.size());
+  ESP_LOGCONFIG(TAG, "  Read changed only: %s", YESNO(this->read_changed_only_));
+  LOG_PIN("  Alert Pin: ", this->alert_pin_);
+  LOG_UPDATE_INTERVAL(this);
+}
+
+}  // namespace i2c_client
+}  // namespace esphome
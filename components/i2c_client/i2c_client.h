@@ -1,11 +1,19 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/hal.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/switch/switch.h"
+#ifdef USE_BINARY_SENSOR
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#endif // USE_BINARY_SENSOR
 #include "esphome/components/i2c/i2c.h"
+#include "../i2c_link/i2c_link.h"
+#include "i2c_client_state.h"
 #include "esphome/core/helpers.h"
 #include <vector>
+#include <cmath>
+#include <limits>
 
 // #ifndef I2C_DEBUG_TIMING // MAX 2 GPTIMERS GLOBALLY, OTHERWISE NOT BOOTING
 // #define I2C_DEBUG_TIMING
@@ -14,16 +22,91 @@
 
 namespace esphome
 {
+namespace i2c
+{
+  struct I2CTransaction;
+  enum TransactionPriority : uint8_t;
+} // namespace i2c
+
 namespace i2c_client
 {
-  static const int SEMAPHORE_TIMEOUT = 5; // ms
-  typedef union value_u
+  /// @brief link commands, must match i2c_slave
+  static const uint8_t I2C_CMD_BURST_READ = 0xF0; ///< [cmd, start_key, count]: reply with count consecutive registers
+  static const uint8_t I2C_CMD_DIRTY_READ = 0xF1; ///< [cmd]: reply with the changed-registers bitmap and clear it
+  static const uint8_t I2C_CMD_DRAIN = 0xF2;      ///< [cmd, key, max_count]: reply with the oldest samples of key
+  static const uint8_t I2C_CMD_AGGREGATE = 0xF3;  ///< [cmd, key]: reply with the aggregates of key and restart them
+  static const uint8_t I2C_CMD_STATUS = 0xF4;     ///< [cmd]: reply with the status word (see i2c::I2C_TURNAROUND_PROBE_CMD)
+  static const uint8_t I2C_DRAIN_MAX = 64;        ///< max size of a drain reply, must match i2c_slave
+
+  /// @brief aggregates of the samples of a register since the last read (reply of I2C_CMD_AGGREGATE), must match
+  /// i2c_slave
+  typedef struct
   {
-    float value_fl;
-    uint8_t value_raw[4];
-  } value_t;
+    float min;
+    float max;
+    float mean;
+    float last;
+    uint32_t count;
+  } aggregate_t;
+  static const uint8_t I2C_DIRTY_BITMAP_SIZE = 32; ///< one bit per registry key, bit (key & 7) of byte (key >> 3)
+
+  // register types and value encoding, shared with the other end of the link
+  using i2c_link::RegisterType;
+  using i2c_link::REG_TYPE_FLOAT;
+  using i2c_link::REG_TYPE_U8;
+  using i2c_link::REG_TYPE_I16;
+  using i2c_link::REG_TYPE_U32;
+  using i2c_link::REG_TYPE_I64;
+  using i2c_link::REG_TYPE_DOUBLE;
+  using i2c_link::I2C_REG_SIZE_MAX;
+  using i2c_link::value_t;
+  using i2c_link::register_type_size;
+  using i2c_link::encode_value;
+  using i2c_link::decode_value;
+
+  /// @brief health of one slave (bus + address), shared by all clients of that slave: a circuit breaker that skips
+  /// the polls of a slave that stopped responding, instead of letting every register time out on every update
+  /// @details The breaker itself is a HealthBreaker (i2c_client_state.h), this adds the time and the logging.
+  /// Commands are never skipped, their results count like those of polls.
+  class DeviceHealth
+  {
+  public:
+    /// @brief the health of the slave at address on bus, created on first use (look it up once, f.e. in setup)
+    static DeviceHealth *get(i2c::I2CBus *bus, uint8_t address);
+
+    /// @brief true if a poll may be sent now, O(1)
+    bool allow_poll();
+    /// @brief result of a transaction with the slave
+    void record(i2c::ErrorCode error);
+    bool is_down() const { return breaker_.get_state() != HealthBreaker::STATE_UP; }
+
+  protected:
+    DeviceHealth(i2c::I2CBus *bus, uint8_t address) : bus_(bus), address_(address) {}
+
+    i2c::I2CBus *bus_;
+    uint8_t address_;
+    HealthBreaker breaker_;
+  };
+
+  /// @brief a register on the i2c slave that can be read by the I2CClientComponent hub
+  class I2CClientRegister
+  {
+  public:
+    virtual uint8_t get_registry_key() const = 0;
+
+    /// @brief type of the register, must match the type configured on the slave
+    void set_register_type(RegisterType type) { register_type_ = type; }
+    RegisterType get_register_type() const { return register_type_; }
+    uint8_t get_register_size() const { return register_type_size(register_type_); }
+
+    /// @brief publish a register value read from the i2c slave (f.e. by a burst read)
+    virtual void publish_value(const value_t &val) = 0;
 
-  class I2CClientSensor : public PollingComponent, public i2c::I2CDevice
+  protected:
+    RegisterType register_type_{REG_TYPE_FLOAT};
+  };
+
+  class I2CClientSensor : public PollingComponent, public i2c::I2CDevice, public I2CClientRegister
   {
   public:
     void setup() override;
@@ -35,9 +118,36 @@ namespace i2c_client
 
     void set_sensor(sensor::Sensor *sensor) { sensor_ = sensor; };
 
+    /// @brief drain the sample history of the registry (see i2c_service sample_fifo) and publish every sample in
+    /// order, instead of reading the latest value
+    void set_drain_samples(bool drain_samples) { drain_samples_ = drain_samples; };
+
+    /// @brief read the aggregates of the registry since the last read (see i2c_service aggregate), the sensor gets
+    /// the last value
+    void set_aggregate(bool aggregate) { aggregate_ = aggregate; };
+    void set_min_sensor(sensor::Sensor *sensor) { min_sensor_ = sensor; };
+    void set_max_sensor(sensor::Sensor *sensor) { max_sensor_ = sensor; };
+    void set_mean_sensor(sensor::Sensor *sensor) { mean_sensor_ = sensor; };
+    void set_count_sensor(sensor::Sensor *sensor) { count_sensor_ = sensor; };
+
+    uint8_t get_registry_key() const override { return reg_key_; };
+    void publish_value(const value_t &val) override;
+
   protected:
+    static void on_read_done_(const i2c::I2CTransaction &txn);
+    void publish_samples_(const i2c::I2CTransaction &txn);
+    void publish_aggregate_(const i2c::I2CTransaction &txn);
+
     uint8_t reg_key_{0x0};
     sensor::Sensor *sensor_{nullptr};
+    bool pending_{false}; ///< a request is queued on the bus worker
+    bool drain_samples_{false};
+    bool aggregate_{false};
+    sensor::Sensor *min_sensor_{nullptr};
+    sensor::Sensor *max_sensor_{nullptr};
+    sensor::Sensor *mean_sensor_{nullptr};
+    sensor::Sensor *count_sensor_{nullptr};
+    DeviceHealth *health_{nullptr}; ///< shared with the other clients of the slave, looked up on the first update
 
     /** last error code from i2c operation
      */
@@ -50,7 +160,7 @@ namespace i2c_client
   };
 
   // class I2CClientSwitch : public switch_::Switch, public Component, public i2c::I2CDevice
-  class I2CClientSwitch : public switch_::Switch, public PollingComponent, public i2c::I2CDevice
+  class I2CClientSwitch : public switch_::Switch, public PollingComponent, public i2c::I2CDevice, public I2CClientRegister
   {
   public:
     void setup() override;
@@ -62,14 +172,27 @@ namespace i2c_client
     void set_registry_key_turnon(uint8_t key) { reg_key_turnon_ = key; };
     void set_registry_key_turnoff(uint8_t key) { reg_key_turnoff_ = key; };
 
+    /// @brief switch by writing the new state as payload into the read-registry, instead of the turnon/turnoff keys
+    void set_write_payload(bool write_payload) { write_payload_ = write_payload; };
+
+    uint8_t get_registry_key() const override { return reg_key_read_; };
+    void publish_value(const value_t &val) override;
+
     // void set_switch(switch_::Switch *sw) { switch_ = sw; };
 
   protected:
     void write_state(bool state) override; // this implements write_state(..) from switch_::Switch
-    bool request_remote_state(uint8_t *reg_key_, bool *st);
+    bool request_remote_state(uint8_t reg_key, i2c::TransactionPriority priority);
+    bool write_remote_value(uint8_t reg_key, const value_t &val, i2c::TransactionPriority priority);
+    bool write_remote_command(uint8_t reg_key, bool state, i2c::TransactionPriority priority);
+    static void on_response_(const i2c::I2CTransaction &txn);
+    DeviceHealth *health_of_slave_();
     uint8_t reg_key_read_{0x0};
     uint8_t reg_key_turnon_{0x0};
     uint8_t reg_key_turnoff_{0x0};
+    uint8_t pending_{0}; ///< number of requests queued on the bus worker
+    bool write_payload_{false};
+    DeviceHealth *health_{nullptr}; ///< shared with the other clients of the slave, looked up on first use
 
     /** last error code from i2c operation
      */
@@ -81,5 +204,101 @@ namespace i2c_client
 // #endif // I2C_DEBUG_TIMING
   };
 
+#ifdef USE_BINARY_SENSOR
+  /// @brief Up to 8 (u8) or 32 (u32) binary sensors, packed in the bits of one register on the i2c slave
+  class I2CClientBinarySensor : public PollingComponent, public i2c::I2CDevice, public I2CClientRegister
+  {
+  public:
+    void update() override;
+    void dump_config() override;
+    float get_setup_priority() const override { return setup_priority::DATA; };
+
+    void set_registry_key(uint8_t key) { reg_key_ = key; };
+
+    /// @brief publish bit of the register as the state of the binary sensor
+    void add_binary_sensor(binary_sensor::BinarySensor *sensor, uint8_t bit) { binary_sensors_.push_back({sensor, bit}); };
+
+    uint8_t get_registry_key() const override { return reg_key_; };
+    void publish_value(const value_t &val) override;
+
+  protected:
+    struct BinarySensorBit
+    {
+      binary_sensor::BinarySensor *sensor;
+      uint8_t bit;
+    };
+
+    static void on_read_done_(const i2c::I2CTransaction &txn);
+
+    uint8_t reg_key_{0x0};
+    std::vector<BinarySensorBit> binary_sensors_;
+    bool pending_{false}; ///< a request is queued on the bus worker
+    DeviceHealth *health_{nullptr}; ///< shared with the other clients of the slave, looked up on the first update
+
+    /** last error code from i2c operation
+     */
+    i2c::ErrorCode last_error_;
+  };
+#endif // USE_BINARY_SENSOR
+
+  /// @brief Hub for one i2c slave address, polls the registers of all its sensors/switches in one scheduled batch.
+  /// @details Registers with consecutive keys are read together with a burst read, so the number of bus transactions
+  /// per update is the number of key ranges instead of the number of values.
+  class I2CClientComponent : public PollingComponent, public i2c::I2CDevice
+  {
+  public:
+    void setup() override;
+    void update() override;
+    void dump_config() override;
+    // set up before the sensors/switches, they take over the hub's bus/address in setup()
+    float get_setup_priority() const override { return setup_priority::DATA + 1.0f; };
+
+    /// @brief let the hub poll the sensor, the sensor is moved to the hub's bus/address and stops polling on its own
+    void register_sensor(I2CClientSensor *sensor);
+
+    /// @brief let the hub poll the switch state, the switch is moved to the hub's bus/address and stops polling on
+    /// its own (commands are still sent by the switch)
+    void register_switch(I2CClientSwitch *sw);
+
+#ifdef USE_BINARY_SENSOR
+    /// @brief let the hub poll the packed binary sensors, moved to the hub's bus/address like sensors
+    void register_binary_sensor(I2CClientBinarySensor *binary_sensor);
+#endif // USE_BINARY_SENSOR
+
+    /// @brief read the slave's dirty bitmap first and only fetch the registers that changed since the last update
+    void set_read_changed_only(bool read_changed_only) { read_changed_only_ = read_changed_only; }
+
+    /// @brief alert line of the slave, a falling edge triggers an update right away (the dirty bitmap is read then)
+    void set_alert_pin(InternalGPIOPin *alert_pin) { alert_pin_ = alert_pin; }
+
+    void loop() override;
+
+  protected:
+    std::vector<I2CClientSensor *> sensors_;
+    std::vector<I2CClientSwitch *> switches_;
+#ifdef USE_BINARY_SENSOR
+    std::vector<I2CClientBinarySensor *> binary_sensors_;
+#endif // USE_BINARY_SENSOR
+    std::vector<I2CClientRegister *> registers_; // sorted by registry key in setup()
+    uint8_t pending_{0};                          ///< burst reads of the current update queued on the bus worker
+    bool update_failed_{false};                   ///< a burst read of the current update failed
+    bool read_changed_only_{false};
+    bool resync_{true}; ///< read all registers on the next update (first update, or changes may have been missed)
+    InternalGPIOPin *alert_pin_{nullptr};
+    AlertTrigger alert_;                   ///< edges from the alert pin ISR, handled in loop()
+    DeviceHealth *health_{nullptr};        ///< shared with the clients of the slave outside the hub
+
+    static void alert_isr_(I2CClientComponent *arg);
+
+    static void on_dirty_done_(const i2c::I2CTransaction &txn);
+    static void on_burst_done_(const i2c::I2CTransaction &txn);
+    void queue_burst_reads_(const uint8_t *dirty);
+    void update_done_();
+
+    /** last error code from i2c operation
+     */
+    i2c::ErrorCode last_error_;
+  };
+
 } // namespace i2c_client
 } // namespace esphome
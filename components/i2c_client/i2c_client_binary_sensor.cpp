@@ -0,0 +1,89 @@
+#include <cstring>
+#include "i2c_client.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "../i2c/i2c_bus_esp_idf.h"
+
+#ifdef USE_BINARY_SENSOR
+
+namespace esphome {
+namespace i2c_client {
+
+static const char *const TAG = "i2c_client.binary_sensor";
+
+void I2CClientBinarySensor::update() {
+
+  esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
+
+  if (this->pending_) {
+    ESP_LOGV(TAG, "Request of reg(0x%02X) still pending", reg_key_);
+    return;
+  }
+  if (this->health_ == nullptr)
+    this->health_ = DeviceHealth::get(this->bus_, this->address_);
+  if (!this->health_->allow_poll()) {
+    ESP_LOGVV(TAG, "Slave 0x%02X down, request of reg(0x%02X) skipped", this->address_, reg_key_);
+    return;
+  }
+
+  // all packed states with one register read, in one transaction run by the bus worker
+  i2c::I2CTransaction *txn = bus->acquire();
+  if (txn == nullptr) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("No free bus transaction");
+    return;
+  }
+  txn->address = this->address_;
+  txn->write_data[0] = reg_key_;
+  txn->write_len = 1;
+  txn->read_len = this->get_register_size();
+  txn->priority = i2c::PRIORITY_POLL;
+  txn->callback = on_read_done_;
+  txn->arg = this;
+  if (!bus->submit(txn)) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("Failed to queue request");
+    return;
+  }
+  this->pending_ = true;
+}
+
+// static class member function, called on the main loop when the transaction completed
+void I2CClientBinarySensor::on_read_done_(const i2c::I2CTransaction &txn) {
+  I2CClientBinarySensor *this_ = (I2CClientBinarySensor *)txn.arg;
+  this_->pending_ = false;
+  this_->last_error_ = txn.error;
+  this_->health_->record(txn.error);
+
+  if (this_->last_error_ != i2c::ERROR_OK) {
+    // Warning will be printed only if warning status is not set yet
+    this_->status_set_warning("Binary sensor read failed");
+    return;
+  }
+  this_->status_clear_warning();
+
+  value_t buf{};
+  memcpy(buf.value_raw, txn.read_data, txn.read_len);
+  this_->publish_value(buf);
+}
+
+void I2CClientBinarySensor::publish_value(const value_t &val) {
+  uint32_t bits = (uint32_t) decode_value(this->register_type_, val);
+  ESP_LOGVV(TAG, "Received reg(0x%02X): 0x%08X", this->reg_key_, (unsigned) bits);
+  for (auto &entry : this->binary_sensors_)
+    entry.sensor->publish_state((bits >> entry.bit) & 1);
+}
+
+void I2CClientBinarySensor::dump_config() {
+  ESP_LOGCONFIG(TAG, "I2C Client Binary Sensor:");
+  LOG_I2C_DEVICE(this);
+  ESP_LOGCONFIG(TAG, "  Registry key: 0x%02X", this->reg_key_);
+  ESP_LOGCONFIG(TAG, "  Binary sensors: %u", (unsigned) this->binary_sensors_.size());
+  LOG_UPDATE_INTERVAL(this);
+}
+
+}  // namespace i2c_client
+}  // namespace esphome
+
+#endif  // USE_BINARY_SENSOR
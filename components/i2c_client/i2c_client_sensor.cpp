@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstring>
 #include "i2c_client.h"
 #include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
@@ -47,72 +48,135 @@ void I2CClientSensor::update() {
 
   esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
 
-  #ifdef I2C_DEBUG_TIMING
-  uint64_t t[5] = {0};
-  uint8_t ti = 0;
-  t[ti++] = bus->timestamp();
-  ESP_LOGVV(TAG, "[%lld : %7.3f ms] Sensor update started", t[0], 0.0f);
-#endif // I2C_DEBUG_TIMING
+  if (this->pending_) {
+    ESP_LOGV(TAG, "Request of reg(0x%02X) still pending", reg_key_);
+    return;
+  }
+  if (this->health_ == nullptr)
+    this->health_ = DeviceHealth::get(this->bus_, this->address_);
+  if (!this->health_->allow_poll()) {
+    ESP_LOGVV(TAG, "Slave 0x%02X down, request of reg(0x%02X) skipped", this->address_, reg_key_);
+    return;
+  }
 
-// Synchronize
-  xSemaphoreTake(bus->semaphore_, SEMAPHORE_TIMEOUT / portTICK_PERIOD_MS);
+  // Send command and read the value after a repeated start, in one transaction run by the bus worker
+  i2c::I2CTransaction *txn = bus->acquire();
+  if (txn == nullptr) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("No free bus transaction");
+    return;
+  }
+  txn->address = this->address_;
+  if (this->drain_samples_) {
+    // as many samples as fit in one reply, the slave pads the reply to a multiple of 4 bytes
+    uint8_t sample_size = 4 + this->get_register_size();
+    uint8_t max_count = (I2C_DRAIN_MAX - 4) / sample_size;
+    txn->write_data[0] = I2C_CMD_DRAIN;
+    txn->write_data[1] = reg_key_;
+    txn->write_data[2] = max_count;
+    txn->write_len = 3;
+    txn->read_len = (4 + max_count * sample_size + 3) & ~3;
+  } else if (this->aggregate_) {
+    txn->write_data[0] = I2C_CMD_AGGREGATE;
+    txn->write_data[1] = reg_key_;
+    txn->write_len = 2;
+    txn->read_len = sizeof(aggregate_t);
+  } else {
+    txn->write_data[0] = reg_key_;
+    txn->write_len = 1;
+    txn->read_len = this->get_register_size();
+  }
+  txn->priority = i2c::PRIORITY_POLL;
+  txn->callback = on_read_done_;
+  txn->arg = this;
+  if (!bus->submit(txn)) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("Failed to queue request");
+    return;
+  }
+  this->pending_ = true;
+}
 
-#ifdef I2C_DEBUG_TIMING
-  t[ti++] = bus->timestamp();
-  ESP_LOGVV(TAG,"[%lld : %7.3f ms] Took semaphore(%p): current value: %d", t[ti-1], (float)((t[ti-1] - t[ti-2]) / 1000.0), &(bus->semaphore_), uxSemaphoreGetCount(bus->semaphore_));
-#endif // I2C_DEBUG_TIMING
+// static class member function, called on the main loop when the transaction completed
+void I2CClientSensor::on_read_done_(const i2c::I2CTransaction &txn) {
+  I2CClientSensor *this_ = (I2CClientSensor *)txn.arg;
+  this_->pending_ = false;
+  this_->last_error_ = txn.error;
+  this_->health_->record(txn.error);
 
-  // Send command
-  last_error_ = this->write((uint8_t *)&reg_key_, 1);
-  if (last_error_ != i2c::ERROR_OK) {
+  if (this_->last_error_ != i2c::ERROR_OK) {
     // Warning will be printed only if warning status is not set yet
-    this->status_set_warning("Failed to send command");
+    this_->status_set_warning("Sensor read failed");
     return;
   }
+  this_->status_clear_warning();
 
-#ifdef I2C_DEBUG_TIMING
-  t[ti++] = bus->timestamp();
-  ESP_LOGVV(TAG,"[%lld : %7.3f ms] Wrote command(0x%02X)", t[ti-1], (float)((t[ti-1] - t[ti-2]) / 1000.0), reg_key_);
-  this->set_timeout(SEMAPHORE_TIMEOUT, [this, bus, t, ti]() {
-#else
-  this->set_timeout(SEMAPHORE_TIMEOUT, [this, bus]() {
-#endif // I2C_DEBUG_TIMING
-
-    value_t buf = { .value_fl = 0.0f };
-    last_error_ = this->read((uint8_t *)&(buf.value_raw), 4);
-
-    if (last_error_ != i2c::ERROR_OK) {
-      ESP_LOGW(TAG, "Sensor read failed");
-      this->status_set_warning();
-      return;
-    }
-    this->status_clear_warning();
-
-#ifdef I2C_DEBUG_TIMING
-    uint64_t t0 = bus->timestamp();
-
-    ESP_LOGVV(TAG, "[%lld : %7.3f ms] Received reg(0x%02X): 0x%02X 0x%02X 0x%02X 0x%02X <==> %.2f", t0, (float)((t0 - t[ti-1]) / 1000.0), reg_key_, buf.value_raw[0], buf.value_raw[1], buf.value_raw[2], buf.value_raw[3], buf.value_fl);
-#endif // I2C_DEBUG_TIMING
-
-    // Evaluate and publish measurements
-    if (this->sensor_ != nullptr) {
-      this->sensor_->publish_state(buf.value_fl);
-    }
-
-#ifdef I2C_DEBUG_TIMING
-    uint64_t t1 = bus->timestamp();
-    ESP_LOGVV(TAG,"[%lld : %7.3f ms] Published state", t1, (float)((t1 - t0) / 1000.0));
-#endif // I2C_DEBUG_TIMING
-
-    // Release seamphore
-    xSemaphoreGive(bus->semaphore_);
-
-#ifdef I2C_DEBUG_TIMING
-    uint64_t t2 = bus->timestamp();
-    ESP_LOGVV(TAG,"[%lld : %7.3f ms] Gave semaphore(%p): value: %d", t2, (float)((t2 - t1) / 1000.0), &(bus->semaphore_), uxSemaphoreGetCount(bus->semaphore_));
-#endif // I2C_DEBUG_TIMING
-
-  });
+  if (txn.write_data[0] == I2C_CMD_DRAIN) {
+    this_->publish_samples_(txn);
+    return;
+  }
+  if (txn.write_data[0] == I2C_CMD_AGGREGATE) {
+    this_->publish_aggregate_(txn);
+    return;
+  }
+
+  value_t buf{};
+  memcpy(buf.value_raw, txn.read_data, txn.read_len);
+  ESP_LOGVV(TAG, "Received reg(0x%02X): %u bytes, 0x%02X 0x%02X 0x%02X 0x%02X ... <==> %.2f", this_->reg_key_, txn.read_len, buf.value_raw[0], buf.value_raw[1], buf.value_raw[2], buf.value_raw[3], decode_value(this_->register_type_, buf));
+
+  // Evaluate and publish measurements
+  this_->publish_value(buf);
+}
+
+// drain reply: [count, remaining, dropped, 0] followed by count samples [timestamp (4 bytes), value (size of the type)]
+void I2CClientSensor::publish_samples_(const i2c::I2CTransaction &txn) {
+  uint8_t count = txn.read_data[0];
+  uint8_t remaining = txn.read_data[1];
+  uint8_t dropped = txn.read_data[2];
+  uint8_t size = this->get_register_size();
+  if (dropped > 0)
+    ESP_LOGW(TAG, "Slave dropped %u sample(s) of reg(0x%02X), drain more often", dropped, this->reg_key_);
+
+  size_t offset = 4;
+  for (uint8_t n = 0; n < count && offset + 4 + size <= txn.read_len; n++) {
+    uint32_t timestamp;
+    value_t val{};
+    memcpy(&timestamp, txn.read_data + offset, 4);
+    memcpy(val.value_raw, txn.read_data + offset + 4, size);
+    offset += 4 + size;
+    ESP_LOGVV(TAG, "Sample of reg(0x%02X) at %u ms: %.2f", this->reg_key_, (unsigned) timestamp, decode_value(this->register_type_, val));
+    this->publish_value(val);
+  }
+
+  // more samples waiting, keep draining instead of waiting for the next update
+  if (remaining > 0)
+    this->update();
+}
+
+void I2CClientSensor::publish_aggregate_(const i2c::I2CTransaction &txn) {
+  aggregate_t aggregate;
+  memcpy(&aggregate, txn.read_data, sizeof(aggregate));
+  ESP_LOGVV(TAG, "Aggregates of reg(0x%02X): min %.2f, max %.2f, mean %.2f, last %.2f, count %u", this->reg_key_,
+            aggregate.min, aggregate.max, aggregate.mean, aggregate.last, (unsigned) aggregate.count);
+
+  if (this->count_sensor_ != nullptr)
+    this->count_sensor_->publish_state(aggregate.count);
+  if (aggregate.count == 0)
+    return; // no new samples since the last read, keep the previous states
+  if (this->min_sensor_ != nullptr)
+    this->min_sensor_->publish_state(aggregate.min);
+  if (this->max_sensor_ != nullptr)
+    this->max_sensor_->publish_state(aggregate.max);
+  if (this->mean_sensor_ != nullptr)
+    this->mean_sensor_->publish_state(aggregate.mean);
+  if (this->sensor_ != nullptr)
+    this->sensor_->publish_state(aggregate.last);
+}
+
+void I2CClientSensor::publish_value(const value_t &val) {
+  if (this->sensor_ != nullptr) {
+    this->sensor_->publish_state(decode_value(this->register_type_, val));
+  }
 }
 
 void I2CClientSensor::dump_config() {
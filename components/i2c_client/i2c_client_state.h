@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <algorithm>
+
+// State machines of the i2c_client hub and its clients, without ESPHome dependencies so the host tests run the same
+// code (see tests/). The components feed them the time and the transaction results.
+
+namespace esphome
+{
+namespace i2c_client
+{
+  static const uint8_t I2C_HEALTH_FAILURES = 3;            ///< consecutive failed transactions that take a slave down
+  static const uint32_t I2C_HEALTH_BACKOFF_MIN_MS = 1000;  ///< first wait before a down slave is probed again
+  static const uint32_t I2C_HEALTH_BACKOFF_MAX_MS = 60000; ///< the wait doubles after every failed probe, up to this
+
+  /// @brief circuit breaker of one slave, see DeviceHealth
+  /// @details After I2C_HEALTH_FAILURES consecutive failures the slave is down (open). Once the backoff passed a
+  /// single poll is let through as a probe (half-open): if it succeeds the slave is up again (closed), if not the
+  /// backoff doubles. Failures that arrive while the slave is down were sent before it went down (still queued or in
+  /// flight on the bus worker), they are counted but don't move the next probe.
+  class HealthBreaker
+  {
+  public:
+    enum State : uint8_t
+    {
+      STATE_UP,    ///< closed, every poll is sent
+      STATE_DOWN,  ///< open, polls are skipped until retry_at_
+      STATE_PROBE, ///< half-open, one poll was let through, the others are skipped until its result
+    };
+
+    /// @brief true if a poll may be sent at now (ms), O(1)
+    bool allow_poll(uint32_t now)
+    {
+      if (this->state_ == STATE_UP)
+        return true;
+      if ((int32_t)(now - this->retry_at_) < 0)
+        return false;
+      // backoff passed (or the last probe never reported): let this poll through as the probe
+      this->state_ = STATE_PROBE;
+      this->retry_at_ = now + this->backoff_ms_;
+      return true;
+    }
+
+    /// @brief result of a transaction with the slave, completed at now (ms)
+    void record(bool ok, uint32_t now)
+    {
+      if (ok)
+      {
+        this->state_ = STATE_UP;
+        this->failures_ = 0;
+        this->backoff_ms_ = 0;
+        return;
+      }
+      if (this->failures_ < UINT8_MAX)
+        this->failures_++;
+      switch (this->state_)
+      {
+      case STATE_UP:
+        if (this->failures_ < I2C_HEALTH_FAILURES)
+          return;
+        this->backoff_ms_ = I2C_HEALTH_BACKOFF_MIN_MS;
+        break;
+      case STATE_DOWN:
+        return; // sent before the slave went down, the backoff stands
+      case STATE_PROBE:
+        // the probe failed: wait twice as long before the next one
+        this->backoff_ms_ = std::min(this->backoff_ms_ * 2, I2C_HEALTH_BACKOFF_MAX_MS);
+        break;
+      }
+      this->state_ = STATE_DOWN;
+      this->retry_at_ = now + this->backoff_ms_;
+    }
+
+    State get_state() const { return state_; }
+    uint8_t get_failures() const { return failures_; }
+    uint32_t get_backoff_ms() const { return backoff_ms_; }
+
+  protected:
+    State state_{STATE_UP};
+    uint8_t failures_{0};     ///< consecutive failures
+    uint32_t backoff_ms_{0};
+    uint32_t retry_at_{0};    ///< time of the next probe, also a new probe if the last one never reported
+  };
+
+  /// @brief when the hub reads its slave because of the alert line (I2CClientComponent::loop())
+  /// @details A falling edge starts an update, once nothing is pending. The slave releases the line when the dirty
+  /// bitmap is read (I2CSlaveAlert), every change after the read comes with a new edge. The level only covers a line
+  /// that was low before the hub started, and a slave that releases the line late. It counts at start and once after
+  /// a dirty read that brought changes, so a line that stays low costs one empty read, not one per loop.
+  class AlertTrigger
+  {
+  public:
+    /// @brief alert pin ISR, falling edge
+    void on_edge() { edge_ = true; }
+
+    /// @brief main loop, no update pending: true if an update has to start now
+    bool poll(bool line_low)
+    {
+      if (!this->edge_ && !(line_low && this->level_armed_))
+        return false;
+      this->edge_ = false;
+      this->level_armed_ = false;
+      return true;
+    }
+
+    /// @brief the dirty bitmap was read, changed: it had any bit set
+    void on_dirty_read(bool changed) { this->level_armed_ = changed; }
+
+  protected:
+    volatile bool edge_{false};
+    bool level_armed_{true}; ///< the line may already be low when the hub starts, without an edge
+  };
+
+} // namespace i2c_client
+} // namespace esphome
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstring>
 #include "i2c_client.h"
 #include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
@@ -16,96 +17,158 @@ void I2CClientSwitch::setup() {
   ESP_LOGV(TAG, "Initialization complete");
 }
 
-bool I2CClientSwitch::request_remote_state(uint8_t *reg_key, bool *st) {
-
-  esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
-
-#ifdef I2C_DEBUG_TIMING
-  uint64_t t[5] = {0};
-  uint8_t ti = 0;
-  t[ti++] = bus->timestamp();
-  ESP_LOGD(TAG, "[%lld : %4.3f ms] Switch 'request_remote_state' (0x%02X) started", t[0], 0.0f, *reg_key);
-#endif // I2C_DEBUG_TIMING
+DeviceHealth *I2CClientSwitch::health_of_slave_() {
+  if (this->health_ == nullptr)
+    this->health_ = DeviceHealth::get(this->bus_, this->address_);
+  return this->health_;
+}
 
-// Take semaphore to ensure that no other sensor/switch is requesting on i2cbus
-  xSemaphoreTake(bus->semaphore_, SEMAPHORE_TIMEOUT / portTICK_PERIOD_MS);
+bool I2CClientSwitch::request_remote_state(uint8_t reg_key, i2c::TransactionPriority priority) {
 
-#ifdef I2C_DEBUG_TIMING
-  t[ti++] = bus->timestamp();
-  ESP_LOGVV(TAG,"[%lld : %7.3f ms] Took semaphore(%p): value: %d", t[ti-1], (float)((t[ti-1] - t[ti-2]) / 1000.0), &(bus->semaphore_), uxSemaphoreGetCount(bus->semaphore_));
-#endif // I2C_DEBUG_TIMING
+  esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
 
-  // last_error_ = this->write((uint8_t *)&reg_key_state_, 1);
-  last_error_ = this->write(reg_key, 1);
-  if (last_error_ != i2c::ERROR_OK) {
+  // Send command and read the response after a repeated start, in one transaction run by the bus worker
+  i2c::I2CTransaction *txn = bus->acquire();
+  if (txn == nullptr) {
     // Warning will be printed only if warning status is not set yet
-    this->status_set_warning("Failed to send command") ;
+    this->status_set_warning("No free bus transaction");
     return false;
   }
+  txn->address = this->address_;
+  txn->write_data[0] = reg_key;
+  txn->write_len = 1;
+  txn->read_len = this->get_register_size();
+  txn->priority = priority;
+  txn->callback = on_response_;
+  txn->arg = this;
+  if (!bus->submit(txn)) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("Failed to queue request");
+    return false;
+  }
+  this->pending_++;
+  return true;
+}
 
-#ifdef I2C_DEBUG_TIMING
-  t[ti++] = bus->timestamp();
-  ESP_LOGVV(TAG,"[%lld : %7.3f ms] Wrote command(0x%02X)", t[ti-1], (float)((t[ti-1] - t[ti-2]) / 1000.0), *reg_key);
-  this->set_timeout(SEMAPHORE_TIMEOUT, [this, bus, reg_key, t, ti]() {
-#else
-  this->set_timeout(SEMAPHORE_TIMEOUT, [this, bus, reg_key]() {
-#endif // I2C_DEBUG_TIMING
-
-    value_t buf = { .value_fl = 0.0f };
-
-    last_error_ = this->read((uint8_t *)&(buf.value_raw), 4);
+bool I2CClientSwitch::write_remote_value(uint8_t reg_key, const value_t &val, i2c::TransactionPriority priority) {
 
+  esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
 
-    if (last_error_ != i2c::ERROR_OK) {
-      ESP_LOGW(TAG, "Response read failed");
-      this->status_set_warning();
-      return false;
-    }
+  // write registry key and payload, in one transaction run by the bus worker
+  i2c::I2CTransaction *txn = bus->acquire();
+  if (txn == nullptr) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("No free bus transaction");
+    return false;
+  }
+  txn->address = this->address_;
+  txn->write_data[0] = reg_key;
+  memcpy(txn->write_data + 1, val.value_raw, this->get_register_size());
+  txn->write_len = 1 + this->get_register_size();
+  txn->read_len = 0;
+  txn->priority = priority;
+  txn->callback = on_response_;
+  txn->arg = this;
+  if (!bus->submit(txn)) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("Failed to queue request");
+    return false;
+  }
+  this->pending_++;
+  return true;
+}
 
-    this->status_clear_warning();
+bool I2CClientSwitch::write_remote_command(uint8_t reg_key, bool state, i2c::TransactionPriority priority) {
 
-#ifdef I2C_DEBUG_TIMING
-    uint64_t t0 = bus->timestamp();
-    ESP_LOGVV(TAG, "[%lld : %7.3f ms] Received reg(0x%02X): 0x%02X 0x%02X 0x%02X 0x%02X <==> %.2f", t0, (float)((t0 - t[ti-1]) / 1000.0), *reg_key, buf.value_raw[0], buf.value_raw[1], buf.value_raw[2], buf.value_raw[3], buf.value_fl);
-#endif // I2C_DEBUG_TIMING
+  esphome::i2c::IDFI2CBus *bus = reinterpret_cast<esphome::i2c::IDFI2CBus *>(this->bus_);
 
-    // Evaluate and publish state
-    bool remote_state = (bool)buf.value_fl;
-    if (this->state != remote_state) {
-      this->state = remote_state;
-      this->publish_state(remote_state);
-#ifdef I2C_DEBUG_TIMING
-      uint64_t t3 = bus->timestamp();
-      ESP_LOGVV(TAG, "[%lld : %7.3f ms] Published updated state: %d", t3, (float)((t3 - t0) / 1000.0), remote_state);
-#endif // I2C_DEBUG_TIMING
-    }
+  // write the turnon/turnoff key only: the slave switches later, on its main loop, so reading back right away would
+  // return the old state
+  i2c::I2CTransaction *txn = bus->acquire();
+  if (txn == nullptr) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("No free bus transaction");
+    return false;
+  }
+  txn->address = this->address_;
+  txn->write_data[0] = reg_key;
+  txn->write_len = 1;
+  txn->read_len = 0;
+  txn->priority = priority;
+  txn->callback = on_response_;
+  txn->arg = this;
+  txn->tag = state; // the commanded state, published once the slave acknowledged the command
+  if (!bus->submit(txn)) {
+    // Warning will be printed only if warning status is not set yet
+    this->status_set_warning("Failed to queue request");
+    return false;
+  }
+  this->pending_++;
+  return true;
+}
 
-    // Release seamphore
-    xSemaphoreGive(bus->semaphore_);
+// static class member function, called on the main loop when the transaction completed
+void I2CClientSwitch::on_response_(const i2c::I2CTransaction &txn) {
+  I2CClientSwitch *this_ = (I2CClientSwitch *)txn.arg;
+  this_->pending_--;
+  this_->last_error_ = txn.error;
+  this_->health_of_slave_()->record(txn.error);
 
-#ifdef I2C_DEBUG_TIMING
-    uint64_t t2 = bus->timestamp();
-    ESP_LOGVV(TAG,"[%lld : %7.3f ms] Gave semaphore(%p): value: %d", t2, (float)((t2 - t0) / 1000.0), &(bus->semaphore_), uxSemaphoreGetCount(bus->semaphore_));
-#endif // I2C_DEBUG_TIMING
+  if (this_->last_error_ != i2c::ERROR_OK) {
+    // Warning will be printed only if warning status is not set yet
+    this_->status_set_warning("Response read failed");
+    return;
+  }
+  this_->status_clear_warning();
+
+  value_t buf{};
+  if (txn.read_len == 0 && txn.write_len == 1) {
+    // turnon/turnoff command, the slave accepted it: the next poll shows if it really switched
+    buf = encode_value(this_->register_type_, txn.tag ? 1.0 : 0.0);
+  } else if (txn.read_len == 0) {
+    // payload write, the slave accepted the state that was written
+    memcpy(buf.value_raw, txn.write_data + 1, txn.write_len - 1);
+  } else {
+    memcpy(buf.value_raw, txn.read_data, txn.read_len);
+  }
+  ESP_LOGVV(TAG, "Received reg(0x%02X): 0x%02X 0x%02X 0x%02X 0x%02X ... <==> %.2f", txn.write_data[0], buf.value_raw[0], buf.value_raw[1], buf.value_raw[2], buf.value_raw[3], decode_value(this_->register_type_, buf));
 
-    return true;
-  });
+  // Evaluate and publish state
+  this_->publish_value(buf);
+}
 
-  return true;
+void I2CClientSwitch::publish_value(const value_t &val) {
+  bool remote_state = decode_value(this->register_type_, val) != 0.0;
+  if (this->state != remote_state) {
+    this->state = remote_state;
+    this->publish_state(remote_state);
+  }
 }
 
 // Override write_state(..) from switch_::Switch
 void I2CClientSwitch::write_state(bool state) {
-  bool st = false;
-  // request to turnon/turnoff the remote switch
-  state == true ? request_remote_state(&reg_key_turnon_, &st) : request_remote_state(&reg_key_turnoff_, &st);
+  // commands go ahead of the background polls on the bus
+  if (this->write_payload_) {
+    // write [read-key, state] in one transaction, the state is published once the slave acknowledged it
+    write_remote_value(reg_key_read_, encode_value(this->register_type_, state ? 1.0 : 0.0), i2c::PRIORITY_COMMAND);
+    return;
+  }
+  // request to turnon/turnoff the remote switch, the commanded state is published once the slave acknowledged it
+  write_remote_command(state ? reg_key_turnon_ : reg_key_turnoff_, state, i2c::PRIORITY_COMMAND);
 }
 
 // Override update() from PollingComponent
 void I2CClientSwitch::update() {
-  bool st = false;
+  if (this->pending_ > 0) {
+    ESP_LOGV(TAG, "Request still pending");
+    return;
+  }
+  if (!this->health_of_slave_()->allow_poll()) {
+    ESP_LOGVV(TAG, "Slave 0x%02X down, state request skipped", this->address_);
+    return;
+  }
   // request read-reg = read-only state of remote switch
-  request_remote_state(&reg_key_read_, &st);
+  request_remote_state(reg_key_read_, i2c::PRIORITY_POLL);
 }
 
 void I2CClientSwitch::dump_config() {
@@ -115,6 +178,7 @@ void I2CClientSwitch::dump_config() {
     ESP_LOGE(TAG, ESP_LOG_MSG_COMM_FAIL);
   }
   ESP_LOGCONFIG(TAG, "   Switch state: %s.", this->state  ? "ON" : "OFF");
+  ESP_LOGCONFIG(TAG, "   Write payload: %s", YESNO(this->write_payload_));
   LOG_SWITCH("", "   Switch", this);
 }
 
@@ -1,5 +1,5 @@
 import esphome.codegen as cg
-from esphome.components import i2c, sensor
+from esphome.components import i2c, i2c_client, sensor
 import esphome.config_validation as cv
 from esphome.const import (
     CONF_ID,
@@ -21,18 +21,54 @@ DEPENDENCIES = ["i2c"] # client depends on i2c master (extends I2CDevice)
 CONF_WIFI_SIGNAL = "wifi_signal"
 CONF_UPTIME = "uptime"
 CONF_I2C_REG_KEY = "i2c_registry_key"
+CONF_DRAIN_SAMPLES = "drain_samples"
+CONF_AGGREGATE = "aggregate"
+CONF_MIN = "min"
+CONF_MAX = "max"
+CONF_MEAN = "mean"
+CONF_COUNT = "count"
 
 i2c_client_ns = cg.esphome_ns.namespace("i2c_client")
 I2CClientSensor = i2c_client_ns.class_("I2CClientSensor", cg.PollingComponent, i2c.I2CDevice)
 
-CONFIG_SCHEMA = (
+def _validate_drain(config):
+    for key in (CONF_DRAIN_SAMPLES, CONF_AGGREGATE):
+        if config[key] and i2c_client.CONF_I2C_CLIENT_ID in config:
+            raise cv.Invalid(
+                f"'{key}' can't be used with '{i2c_client.CONF_I2C_CLIENT_ID}', the hub reads the latest value only"
+            )
+    if config[CONF_DRAIN_SAMPLES] and config[CONF_AGGREGATE]:
+        raise cv.Invalid(f"'{CONF_DRAIN_SAMPLES}' and '{CONF_AGGREGATE}' are mutually exclusive")
+    for key in (CONF_MIN, CONF_MAX, CONF_MEAN, CONF_COUNT):
+        if key in config and not config[CONF_AGGREGATE]:
+            raise cv.Invalid(f"'{key}' requires '{CONF_AGGREGATE}: true'")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(I2CClientSensor),
-            cv.Required(CONF_I2C_REG_KEY): cv.hex_uint8_t,
+            cv.Required(CONF_I2C_REG_KEY): i2c_client.i2c_registry_key,
+            cv.Optional(CONF_DRAIN_SAMPLES, default=False): cv.boolean,
+            cv.Optional(CONF_AGGREGATE, default=False): cv.boolean,
             cv.Optional(CONF_SENSOR): sensor.sensor_schema(
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
+            cv.Optional(CONF_MIN): sensor.sensor_schema(
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_MAX): sensor.sensor_schema(
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_MEAN): sensor.sensor_schema(
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_COUNT): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
             cv.Optional(CONF_WIFI_SIGNAL): sensor.sensor_schema(
                 unit_of_measurement=UNIT_DECIBEL_MILLIWATT,
                 accuracy_decimals=0,
@@ -52,12 +88,19 @@ CONFIG_SCHEMA = (
     )
     .extend(cv.polling_component_schema("10s"))
     .extend(i2c.i2c_device_schema(0x0))
+    .extend(i2c_client.i2c_client_hub_schema())
+    .extend(i2c_client.register_type_schema()),
+    _validate_drain,
 )
 
 TYPES = {
     CONF_SENSOR: "set_sensor",
     CONF_WIFI_SIGNAL: "set_sensor",
     CONF_UPTIME: "set_sensor",
+    CONF_MIN: "set_min_sensor",
+    CONF_MAX: "set_max_sensor",
+    CONF_MEAN: "set_mean_sensor",
+    CONF_COUNT: "set_count_sensor",
     # CONF_HUMIDITY: "set_humidity_sensor",
 }
 
@@ -68,6 +111,13 @@ async def to_code(config):
     await i2c.register_i2c_device(var, config)
 
     cg.add(var.set_registry_key(config[CONF_I2C_REG_KEY]))
+    cg.add(var.set_register_type(config[i2c_client.CONF_REGISTER_TYPE]))
+    cg.add(var.set_drain_samples(config[CONF_DRAIN_SAMPLES]))
+    cg.add(var.set_aggregate(config[CONF_AGGREGATE]))
+
+    if i2c_client.CONF_I2C_CLIENT_ID in config:
+        hub = await cg.get_variable(config[i2c_client.CONF_I2C_CLIENT_ID])
+        cg.add(hub.register_sensor(var))
 
     for key, funcName in TYPES.items():
         if key in config:
@@ -1,5 +1,5 @@
 import esphome.codegen as cg
-from esphome.components import i2c, switch
+from esphome.components import i2c, i2c_client, switch
 import esphome.config_validation as cv
 from esphome.const import (
     CONF_ID,
@@ -18,6 +18,7 @@ ICON_TOGGLE = "mdi:toggle-switch"
 CONF_I2C_REG_KEY_READ = "i2c_registry_key_read"
 CONF_I2C_REG_KEY_TURNON = "i2c_registry_key_turnon"
 CONF_I2C_REG_KEY_TURNOFF = "i2c_registry_key_turnoff"
+CONF_WRITE_PAYLOAD = "write_payload"
 
 i2c_client_ns = cg.esphome_ns.namespace("i2c_client")
 # I2CClientSwitch = i2c_client_ns.class_("I2CClientSwitch", switch.Switch, cg.Component, i2c.I2CDevice)
@@ -33,13 +34,16 @@ CONFIG_SCHEMA = (
     )
     .extend(
     {
-        cv.Required(CONF_I2C_REG_KEY_READ): cv.hex_uint8_t,
-        cv.Required(CONF_I2C_REG_KEY_TURNON): cv.hex_uint8_t,
-        cv.Required(CONF_I2C_REG_KEY_TURNOFF): cv.hex_uint8_t,
+        cv.Required(CONF_I2C_REG_KEY_READ): i2c_client.i2c_registry_key,
+        cv.Required(CONF_I2C_REG_KEY_TURNON): i2c_client.i2c_registry_key,
+        cv.Required(CONF_I2C_REG_KEY_TURNOFF): i2c_client.i2c_registry_key,
+        cv.Optional(CONF_WRITE_PAYLOAD, default=False): cv.boolean,
     })
     # .extend(cv.COMPONENT_SCHEMA)
     .extend(cv.polling_component_schema("10s"))
     .extend(i2c.i2c_device_schema(0x0))
+    .extend(i2c_client.i2c_client_hub_schema())
+    .extend(i2c_client.register_type_schema())
 )
 
 async def to_code(config):
@@ -50,4 +54,10 @@ async def to_code(config):
     cg.add(var.set_registry_key_read(config[CONF_I2C_REG_KEY_READ]))
     cg.add(var.set_registry_key_turnon(config[CONF_I2C_REG_KEY_TURNON]))
     cg.add(var.set_registry_key_turnoff(config[CONF_I2C_REG_KEY_TURNOFF]))
+    cg.add(var.set_write_payload(config[CONF_WRITE_PAYLOAD]))
+    cg.add(var.set_register_type(config[i2c_client.CONF_REGISTER_TYPE]))
+
+    if i2c_client.CONF_I2C_CLIENT_ID in config:
+        hub = await cg.get_variable(config[i2c_client.CONF_I2C_CLIENT_ID])
+        cg.add(hub.register_switch(var))
 
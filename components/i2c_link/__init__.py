@@ -0,0 +1,65 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+
+# Wire format shared by i2c_slave (and its services) and i2c_client, and the I2C port pool shared with the i2c
+# master buses. Auto-loaded by i2c, i2c_slave and i2c_client.
+
+CODEOWNERS = ["@pihiandreas"]
+
+i2c_link_ns = cg.esphome_ns.namespace("i2c_link")
+
+CONF_REGISTER_TYPE = "register_type"
+CONF_BINARY_SENSORS = "binary_sensors"
+CONF_BIT = "bit"
+
+I2C_REG_KEY_MAX = 0xEF  # keys above are reserved for link commands (burst read, ...)
+
+RegisterType = i2c_link_ns.enum("RegisterType")
+REGISTER_TYPES = {
+    "float": RegisterType.REG_TYPE_FLOAT,
+    "u8": RegisterType.REG_TYPE_U8,
+    "i16": RegisterType.REG_TYPE_I16,
+    "u32": RegisterType.REG_TYPE_U32,
+    "i64": RegisterType.REG_TYPE_I64,
+    "double": RegisterType.REG_TYPE_DOUBLE,
+}
+
+# bits available in a register of the type
+REGISTER_TYPE_BITS = {
+    "u8": 8,
+    "u32": 32,
+}
+
+CONFIG_SCHEMA = cv.All(cv.Schema({}))
+
+
+def i2c_registry_key(value):
+    """Validate a registry key, the keys above I2C_REG_KEY_MAX are reserved for link commands."""
+    return cv.All(cv.hex_uint8_t, cv.Range(max=I2C_REG_KEY_MAX))(value)
+
+
+def register_type_schema():
+    """Create a schema for the type of a register, must match on both ends of the link.
+
+    :return: The register type schema, `extend` this in your config schema.
+    """
+    return cv.Schema(
+        {
+            cv.Optional(CONF_REGISTER_TYPE, default="float"): cv.enum(REGISTER_TYPES, lower=True),
+        }
+    )
+
+
+def validate_bits(config):
+    """Check that the bits of a binary sensor register fit in its type and are used once."""
+    bits = REGISTER_TYPE_BITS[config[CONF_REGISTER_TYPE]]
+    used = set()
+    for conf in config[CONF_BINARY_SENSORS]:
+        if conf[CONF_BIT] >= bits:
+            raise cv.Invalid(
+                f"Bit {conf[CONF_BIT]} doesn't fit in a '{config[CONF_REGISTER_TYPE]}' register (bits 0-{bits - 1})"
+            )
+        if conf[CONF_BIT] in used:
+            raise cv.Invalid(f"Bit {conf[CONF_BIT]} is used more than once")
+        used.add(conf[CONF_BIT])
+    return config
@@ -0,0 +1,164 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+// Register types and their encoding on the bus, the wire format shared by i2c_slave (and its services) and
+// i2c_client, and the I2C port pool of the chip. Header only, auto-loaded by i2c, i2c_slave and i2c_client.
+
+namespace esphome
+{
+namespace i2c_link
+{
+  /// @brief type of a register value, the number of bytes sent on the bus follows the type
+  enum RegisterType : uint8_t
+  {
+    REG_TYPE_FLOAT = 0, ///< 4 byte float (default)
+    REG_TYPE_U8,        ///< 1 byte unsigned, booleans and enums
+    REG_TYPE_I16,       ///< 2 byte signed
+    REG_TYPE_U32,       ///< 4 byte unsigned, counters
+    REG_TYPE_I64,       ///< 8 byte signed, large counters without precision loss
+    REG_TYPE_DOUBLE,    ///< 8 byte double
+  };
+
+  static const uint8_t I2C_REG_SIZE_MAX = 8; ///< bytes of the widest register type
+
+  typedef union value_u
+  {
+    float value_fl;
+    double value_db;
+    uint8_t value_u8;
+    int16_t value_i16;
+    uint32_t value_u32;
+    int64_t value_i64;
+    uint8_t value_raw[I2C_REG_SIZE_MAX];
+  } value_t;
+
+  /// @brief number of bytes a register of the given type takes on the bus
+  inline __attribute__((always_inline)) uint8_t register_type_size(RegisterType type) // also used by the fast path ISR
+  {
+    switch (type)
+    {
+    case REG_TYPE_U8:
+      return 1;
+    case REG_TYPE_I16:
+      return 2;
+    case REG_TYPE_I64:
+    case REG_TYPE_DOUBLE:
+      return 8;
+    default:
+      return 4;
+    }
+  }
+
+  // round and saturate a value to an integer register type
+  template<typename T> inline T saturate_value_(double val)
+  {
+    if (std::isnan(val))
+      return 0;
+    val = std::round(val);
+    if (val <= (double) std::numeric_limits<T>::min())
+      return std::numeric_limits<T>::min();
+    if (val >= (double) std::numeric_limits<T>::max())
+      return std::numeric_limits<T>::max();
+    return (T) val;
+  }
+
+  /// @brief encode a (sensor) value as a register of the given type, the unused bytes are zero
+  inline value_t encode_value(RegisterType type, double val)
+  {
+    value_t value{};
+    switch (type)
+    {
+    case REG_TYPE_U8:
+      value.value_u8 = saturate_value_<uint8_t>(val);
+      break;
+    case REG_TYPE_I16:
+      value.value_i16 = saturate_value_<int16_t>(val);
+      break;
+    case REG_TYPE_U32:
+      value.value_u32 = saturate_value_<uint32_t>(val);
+      break;
+    case REG_TYPE_I64:
+      value.value_i64 = saturate_value_<int64_t>(val);
+      break;
+    case REG_TYPE_DOUBLE:
+      value.value_db = val;
+      break;
+    default:
+      value.value_fl = (float) val;
+      break;
+    }
+    return value;
+  }
+
+  // saturate an integer to an integer register type
+  template<typename T> inline T saturate_integer_(int64_t val)
+  {
+    if (val <= (int64_t) std::numeric_limits<T>::min())
+      return std::numeric_limits<T>::min();
+    if (val >= (int64_t) std::numeric_limits<T>::max())
+      return std::numeric_limits<T>::max();
+    return (T) val;
+  }
+
+  /// @brief encode an integer (f.e. a counter) as a register of the given type, exact for the integer types where
+  /// encode_value() goes through a double (i64 above 2^53)
+  inline value_t encode_integer(RegisterType type, int64_t val)
+  {
+    value_t value{};
+    switch (type)
+    {
+    case REG_TYPE_U8:
+      value.value_u8 = saturate_integer_<uint8_t>(val);
+      break;
+    case REG_TYPE_I16:
+      value.value_i16 = saturate_integer_<int16_t>(val);
+      break;
+    case REG_TYPE_U32:
+      value.value_u32 = saturate_integer_<uint32_t>(val);
+      break;
+    case REG_TYPE_I64:
+      value.value_i64 = val;
+      break;
+    default:
+      return encode_value(type, (double) val);
+    }
+    return value;
+  }
+
+  /// @brief decode a register of the given type
+  inline double decode_value(RegisterType type, const value_t &value)
+  {
+    switch (type)
+    {
+    case REG_TYPE_U8:
+      return value.value_u8;
+    case REG_TYPE_I16:
+      return value.value_i16;
+    case REG_TYPE_U32:
+      return value.value_u32;
+    case REG_TYPE_I64:
+      return (double) value.value_i64;
+    case REG_TYPE_DOUBLE:
+      return value.value_db;
+    default:
+      return value.value_fl;
+    }
+  }
+
+  /// @brief claim the next unused hardware I2C port, the i2c master buses and the i2c slaves of a chip share one pool
+  /// @param num_ports number of ports of the chip (SOC_HP_I2C_NUM)
+  /// @return the claimed port number, or -1 when all ports are taken
+  /// @note called from the setup() of the components only, so it needs no locking
+  inline int claim_i2c_port(int num_ports)
+  {
+    static int next_port = 0;
+    if (next_port >= num_ports)
+      return -1;
+    return next_port++;
+  }
+
+} // namespace i2c_link
+} // namespace esphome
@@ -0,0 +1,49 @@
+import esphome.codegen as cg
+from esphome.components import i2c_slave, i2c_link, binary_sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ID,
+)
+
+DEPENDENCIES = ["i2c_slave","binary_sensor"] # binary sensor service depends on i2c slave (extends I2CSlaveDevice) and links to binary sensors
+
+CONF_I2C_REG_KEY = "i2c_registry_key"
+CONF_BINARY_SENSOR = "binary_sensor"
+
+i2c_service_ns = cg.esphome_ns.namespace("i2c_service")
+I2CServiceBinarySensorComponent = i2c_service_ns.class_("I2CServiceBinarySensorComponent", cg.Component, i2c_slave.I2CSlaveDevice)
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(I2CServiceBinarySensorComponent),
+            cv.Required(CONF_I2C_REG_KEY): i2c_slave.i2c_registry_key,
+            cv.Optional(i2c_slave.CONF_REGISTER_TYPE, default="u8"): cv.one_of(*i2c_link.REGISTER_TYPE_BITS, lower=True),
+            cv.Required(i2c_link.CONF_BINARY_SENSORS): cv.ensure_list(
+                cv.Schema(
+                    {
+                        cv.Required(CONF_BINARY_SENSOR): cv.use_id(binary_sensor.BinarySensor),
+                        cv.Required(i2c_link.CONF_BIT): cv.int_range(min=0, max=31),
+                    }
+                )
+            ),
+        }
+    )
+    .extend(cv.COMPONENT_SCHEMA)
+    .extend(i2c_slave.i2c_slave_device_schema()),
+    i2c_link.validate_bits,
+)
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+
+    await cg.register_component(var, config)
+    await i2c_slave.register_i2c_slave_device(var, config)
+
+    cg.add(var.set_registry_key(config[CONF_I2C_REG_KEY]))
+    cg.add(var.set_register_type(i2c_slave.REGISTER_TYPES[config[i2c_slave.CONF_REGISTER_TYPE]]))
+
+    for conf in config[i2c_link.CONF_BINARY_SENSORS]:
+        sens = await cg.get_variable(conf[CONF_BINARY_SENSOR])
+        cg.add(var.add_binary_sensor(sens, conf[i2c_link.CONF_BIT]))
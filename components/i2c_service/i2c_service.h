@@ -6,6 +6,10 @@
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/i2c_slave/i2c_slave.h"
+#ifdef USE_BINARY_SENSOR
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#include <vector>
+#endif // USE_BINARY_SENSOR
 
 #ifdef ESP_IDF
 #include <freertos/FreeRTOS.h>
@@ -28,12 +32,25 @@ namespace i2c_service
   {
   public:
     void setup() override;
+    void loop() override;
     void update() override;
     void dump_config() override;
     float get_setup_priority() const override { return setup_priority::DATA; }
 
     void set_registry_key(uint8_t key) { reg_key_ = key; }
 
+    /// @brief type (and size on the bus) of the registry, the sensor state is converted to it
+    void set_register_type(i2c_slave::RegisterType type) { register_type_ = type; }
+
+    /// @brief mirror every new sensor state into the registry as soon as it is published
+    void set_update_on_change(bool update_on_change) { update_on_change_ = update_on_change; }
+
+    /// @brief keep the last samples (timestamped sensor states) for the master to drain, 0 = off
+    void set_sample_fifo(uint16_t capacity) { sample_fifo_ = capacity; }
+
+    /// @brief keep min/max/mean/last/count of the sensor states since the master last read them
+    void set_aggregate(bool aggregate) { aggregate_ = aggregate; }
+
     /// @brief we store the pointer to the Sensor handle to use
     void set_sensor(sensor::Sensor *sensor) { sensor_ = sensor; }
 
@@ -43,15 +60,17 @@ namespace i2c_service
   protected:
     uint8_t reg_key_{0x0};
     sensor::Sensor *sensor_{nullptr}; ///< pointer to I2CSlave instance
+    bool update_on_change_{true};
+    i2c_slave::RegisterType register_type_{i2c_slave::REG_TYPE_FLOAT};
+    uint16_t sample_fifo_{0};
+    bool aggregate_{false};
 
   };
 
-  // class I2CServiceSwitchComponent : public Component, public i2c_slave::I2CSlaveDevice
-  class I2CServiceSwitchComponent : public PollingComponent, public i2c_slave::I2CSlaveDevice
+  class I2CServiceSwitchComponent : public Component, public i2c_slave::I2CSlaveDevice
   {
   public:
     void setup() override;
-    void update() override;
     void dump_config() override;
     float get_setup_priority() const override { return setup_priority::DATA; }
 
@@ -59,22 +78,59 @@ namespace i2c_service
     void set_registry_key_turnon(uint8_t key) { reg_key_turnon_ = key; };
     void set_registry_key_turnoff(uint8_t key) { reg_key_turnoff_ = key; };
 
+    /// @brief type (and size on the bus) of the read/turnon/turnoff registries
+    void set_register_type(i2c_slave::RegisterType type) { register_type_ = type; }
+
     /// @brief we store the pointer to the Switch handle to use
     void set_switch(switch_::Switch *sw) { switch_ = sw; }
 
     /// @brief get the pointer to the Switch object
     switch_::Switch  *get_switch() { return switch_; }
 
-    static void i2c_slave_cb(uint8_t, void *);
+    static void i2c_slave_cb(uint8_t, const uint8_t *, size_t, void *);
 
   protected:
     uint8_t reg_key_read_{0x0};
     uint8_t reg_key_turnon_{0x0};
     uint8_t reg_key_turnoff_{0x0};
+    i2c_slave::RegisterType register_type_{i2c_slave::REG_TYPE_FLOAT};
     switch_::Switch *switch_{nullptr}; ///< pointer to I2CSlave instance
 
     static void synchronize_registries(I2CServiceSwitchComponent *cmp);
   };
 
+#ifdef USE_BINARY_SENSOR
+  /// @brief Packs up to 8 (u8) or 32 (u32) binary sensors into the bits of one registry, the master reads them all
+  /// with a single register read.
+  class I2CServiceBinarySensorComponent : public Component, public i2c_slave::I2CSlaveDevice
+  {
+  public:
+    void setup() override;
+    void dump_config() override;
+    float get_setup_priority() const override { return setup_priority::DATA; }
+
+    void set_registry_key(uint8_t key) { reg_key_ = key; }
+
+    /// @brief type of the registry, u8 (bits 0-7) or u32 (bits 0-31)
+    void set_register_type(i2c_slave::RegisterType type) { register_type_ = type; }
+
+    /// @brief mirror the state of a binary sensor in a bit of the registry
+    void add_binary_sensor(binary_sensor::BinarySensor *sensor, uint8_t bit) { binary_sensors_.push_back({sensor, bit}); }
+
+  protected:
+    struct BinarySensorBit
+    {
+      binary_sensor::BinarySensor *sensor;
+      uint8_t bit;
+    };
+
+    void update_registry_();
+
+    uint8_t reg_key_{0x0};
+    i2c_slave::RegisterType register_type_{i2c_slave::REG_TYPE_U8};
+    std::vector<BinarySensorBit> binary_sensors_;
+  };
+#endif // USE_BINARY_SENSOR
+
 } // namespace i2c_service
 } // namespace esphome
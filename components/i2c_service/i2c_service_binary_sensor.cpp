@@ -0,0 +1,49 @@
+#include "i2c_service.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_BINARY_SENSOR
+
+namespace esphome {
+namespace i2c_service {
+
+static const char *const TAG = "i2c_service.binary_sensor";
+
+void I2CServiceBinarySensorComponent::update_registry_() {
+  uint32_t bits = 0;
+  for (auto &entry : this->binary_sensors_) {
+    if (entry.sensor->state)
+      bits |= 1UL << entry.bit;
+  }
+  // packed bits are stored as they are, a float conversion would drop the high bits of a u32
+  this->get_i2c_slave()->upsert_i2c_registry(this->reg_key_, i2c_slave::encode_value(this->register_type_, bits));
+  ESP_LOGVV(TAG, "Updated registry 0x%02X to 0x%08X", this->reg_key_, (unsigned) bits);
+}
+
+void I2CServiceBinarySensorComponent::setup() {
+  ESP_LOGCONFIG(TAG, "Running setup");
+
+  // register current states as initial value, with the configured type
+  this->get_i2c_slave()->set_type_i2c_registry(this->reg_key_, this->register_type_);
+  this->update_registry_();
+
+  // any state change repacks the registry
+  for (auto &entry : this->binary_sensors_)
+    entry.sensor->add_on_state_callback([this](bool state) { this->update_registry_(); });
+
+  ESP_LOGV(TAG, "Initialization complete");
+}
+
+void I2CServiceBinarySensorComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "I2C Service Binary Sensor:");
+  ESP_LOGCONFIG(TAG, "  I2C Address: 0x%02X", (this->get_i2c_slave())->get_i2c_address());
+  ESP_LOGCONFIG(TAG, "  Registry key: 0x%02X", this->reg_key_);
+  ESP_LOGCONFIG(TAG, "  Registry size: %u bytes", i2c_slave::register_type_size(this->register_type_));
+  ESP_LOGCONFIG(TAG, "  Binary sensors: %u", (unsigned) this->binary_sensors_.size());
+}
+
+}  // namespace i2c_service
+}  // namespace esphome
+
+#endif  // USE_BINARY_SENSOR
@@ -11,11 +11,43 @@ static const char *const TAG = "i2c_service.sensor";
 void I2CServiceSensorComponent::setup() {
   ESP_LOGCONFIG(TAG, "Running setup");
 
-  this->get_i2c_slave()->upsert_i2c_registry(this->reg_key_, 0.0f); // register 0 as initial value
+  // register current state (or 0) as initial value, with the configured type
+  this->get_i2c_slave()->set_type_i2c_registry(this->reg_key_, this->register_type_);
+  this->get_i2c_slave()->upsert_i2c_registry(this->reg_key_, this->sensor_->has_state() ? this->sensor_->state : 0.0f);
+
+  if (this->update_on_change_) {
+    // update the registry whenever the sensor publishes, no need to wait for the next update()
+    this->sensor_->add_on_state_callback([this](float state) {
+      this->get_i2c_slave()->upsert_i2c_registry(this->reg_key_, state);
+    });
+  }
+
+  if (this->sample_fifo_ > 0) {
+    // every published state goes into the sample history, the master drains it in batches
+    this->get_i2c_slave()->enable_fifo_i2c_registry(this->reg_key_, this->sample_fifo_);
+    this->sensor_->add_on_state_callback([this](float state) {
+      if (!this->get_i2c_slave()->push_sample_i2c_registry(this->reg_key_, millis(), state))
+        ESP_LOGVV(TAG, "Sample history of 0x%02X full, sample dropped", this->reg_key_);
+    });
+  }
+
+  if (this->aggregate_) {
+    // every published state goes into the aggregates, the master reads and restarts them
+    this->get_i2c_slave()->enable_aggregate_i2c_registry(this->reg_key_);
+    this->sensor_->add_on_state_callback([this](float state) {
+      this->get_i2c_slave()->add_aggregate_i2c_registry(this->reg_key_, state);
+    });
+  }
 
   ESP_LOGV(TAG, "Initialization complete");
 }
 
+void I2CServiceSensorComponent::loop() {
+  // restart the aggregates once the master read them, also without new sensor states
+  if (this->aggregate_)
+    this->get_i2c_slave()->poll_aggregate_i2c_registry(this->reg_key_);
+}
+
 void I2CServiceSensorComponent::update() {
   this->get_i2c_slave()->upsert_i2c_registry(this->reg_key_, this->sensor_->state);
 }
@@ -24,6 +56,11 @@ void I2CServiceSensorComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "I2C Service Sensor:");
   ESP_LOGCONFIG(TAG, "  I2C Address: 0x%02X", (this->get_i2c_slave())->get_i2c_address());
   ESP_LOGCONFIG(TAG, "  Registry key: 0x%02X", this->reg_key_);
+  ESP_LOGCONFIG(TAG, "  Registry size: %u bytes", i2c_slave::register_type_size(this->register_type_));
+  ESP_LOGCONFIG(TAG, "  Update on change: %s", YESNO(this->update_on_change_));
+  ESP_LOGCONFIG(TAG, "  Sample FIFO: %u", this->sample_fifo_);
+  ESP_LOGCONFIG(TAG, "  Aggregate: %s", YESNO(this->aggregate_));
+  LOG_UPDATE_INTERVAL(this);
   ESP_LOGCONFIG(TAG, "  Registry val: %.2f", this->get_i2c_slave()->read_i2c_registry(this->reg_key_));
   ESP_LOGCONFIG(TAG, "  Sensor state: %.02f", this->sensor_->state);
 }
@@ -2,6 +2,7 @@
 #include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
+#include <algorithm>
 
 namespace esphome {
 namespace i2c_service {
@@ -21,18 +22,31 @@ void I2CServiceSwitchComponent::synchronize_registries(I2CServiceSwitchComponent
 // static class member function, i2c_slave_cb(...)
 // as 'static' it has no access to 'this'-object/instance
 // instead it gets a pointer to 'this' as parameter
-void I2CServiceSwitchComponent::i2c_slave_cb(uint8_t reg_key, void *param) {
+void I2CServiceSwitchComponent::i2c_slave_cb(uint8_t reg_key, const uint8_t *data, size_t len, void *param) {
   I2CServiceSwitchComponent *this_ = (I2CServiceSwitchComponent *)param;
 
   // esphome::i2c_slave::reg_val_t *val = this_->get_i2c_slave()->get_i2c_registry(reg_key);
 
-  if (reg_key == this_->reg_key_turnon_) {
+  if (reg_key == this_->reg_key_read_) {
+    if (len == 0)
+      return; // plain state read, no payload
+    // the new state was written into the read-registry, any non-zero byte means ON
+    bool state = std::any_of(data, data + len, [](uint8_t b) { return b != 0; });
+    ESP_LOGVV(TAG, "Callback called, reg: 0x%02X, payload state: %d", reg_key, state);
+    if (state)
+      this_->switch_->turn_on();
+    else
+      this_->switch_->turn_off();
+  } else if (reg_key == this_->reg_key_turnon_) {
     ESP_LOGVV(TAG, "Callback called, reg: 0x%02X, turning ON switch", reg_key);
     this_->switch_->turn_on();
   } else {
     ESP_LOGVV(TAG, "Callback called, reg: 0x%02X, turning OFF switch", reg_key);
     this_->switch_->turn_off();
   }
+  // The switch state callback synchronizes the registries on a state change. A payload write already stored the
+  // master's value in the read-registry though, and a switch that refuses (interlock, restore mode) publishes
+  // nothing: resync from the actual state (upserts of unchanged values are no-ops).
   synchronize_registries(this_);
 }
 
@@ -40,31 +54,29 @@ void I2CServiceSwitchComponent::setup() {
   ESP_LOGCONFIG(TAG, "Running setup");
 
   // set up triple registry entries
+  this->get_i2c_slave()->set_type_i2c_registry(this->reg_key_read_, this->register_type_);
+  this->get_i2c_slave()->set_type_i2c_registry(this->reg_key_turnon_, this->register_type_);
+  this->get_i2c_slave()->set_type_i2c_registry(this->reg_key_turnoff_, this->register_type_);
   synchronize_registries(this);
 
-  // register the callback for reg_key_turnon_ and reg_key_turnoff_
+  // keep the registries in sync with every state change, local switching included
+  this->switch_->add_on_state_callback([this](bool state) { synchronize_registries(this); });
+
+  // register the callback for reg_key_turnon_, reg_key_turnoff_ and reg_key_read_ (state written as payload)
+  this->get_i2c_slave()->set_cb_i2c_registry(this->reg_key_read_, &i2c_slave_cb, (void *)this); // register a static member function as callback and a pointer to 'this' object/component
   this->get_i2c_slave()->set_cb_i2c_registry(this->reg_key_turnon_, &i2c_slave_cb, (void *)this); // register a static member function as callback and a pointer to 'this' object/component
   this->get_i2c_slave()->set_cb_i2c_registry(this->reg_key_turnoff_, &i2c_slave_cb, (void *)this); // register a static member function as callback and a pointer to 'this' object/component
 
   ESP_LOGV(TAG, "Initialization complete");
 }
 
-void I2CServiceSwitchComponent::update() {
-  // synchronize triple registry entries
-  // local switching does not update registries, so we do it with PollingComponent::update() (=delay)
-  // ESP_LOGVV(TAG, "Current state = %d, 0x%02X = %.2f", this->switch_->state, this->reg_key_read_, this->get_i2c_slave()->read_i2c_registry(this->reg_key_read_));
-
-  if (this->switch_->state != (bool)(this->get_i2c_slave()->read_i2c_registry(this->reg_key_read_))) {
-    synchronize_registries(this);
-  }
-}
-
 void I2CServiceSwitchComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "I2C Service Switch:");
   ESP_LOGCONFIG(TAG, "  I2C Address: 0x%02X", (this->get_i2c_slave())->get_i2c_address());
   ESP_LOGCONFIG(TAG, "  Registry key (read) : 0x%02X", this->reg_key_read_);
   ESP_LOGCONFIG(TAG, "  Registry key (turnon): 0x%02X", this->reg_key_turnon_);
   ESP_LOGCONFIG(TAG, "  Registry key (turnoff): 0x%02X", this->reg_key_turnoff_);
+  ESP_LOGCONFIG(TAG, "  Registry size: %u bytes", i2c_slave::register_type_size(this->register_type_));
   ESP_LOGCONFIG(TAG, "  Registry val (state): %.2f", this->get_i2c_slave()->read_i2c_registry(this->reg_key_read_));
   // ESP_LOGCONFIG(TAG, "  Sensor state: %.02f", this->sensor_->state);
 }
@@ -4,6 +4,7 @@ import esphome.config_validation as cv
 from esphome.const import (
     CONF_HUMIDITY,
     CONF_ID,
+    CONF_UPDATE_INTERVAL,
     CONF_TEMPERATURE,
     CONF_VARIANT,
     DEVICE_CLASS_HUMIDITY,
@@ -18,6 +19,11 @@ DEPENDENCIES = ["i2c_slave","sensor"] # sensor service depends on i2c slave and
 CONF_I2C_SLAVE_ID = "i2c_slave_id"
 CONF_I2C_REG_KEY = "i2c_registry_key"
 CONF_I2C_SVC_SENSOR_ID = "i2c_svc_sensor_id"
+CONF_UPDATE_ON_CHANGE = "update_on_change"
+CONF_SAMPLE_FIFO = "sample_fifo"
+CONF_AGGREGATE = "aggregate"
+
+SCHEDULER_DONT_RUN = 4294967295  # update_interval: never
 
 i2c_service_ns = cg.esphome_ns.namespace("i2c_service")
 I2CServiceSensorComponent = i2c_service_ns.class_("I2CServiceSensorComponent", cg.PollingComponent, i2c_slave.I2CSlaveDevice)
@@ -40,16 +46,34 @@ async def register_i2c_service_sensor(var, config):
     parent = await cg.get_variable(config[CONF_I2C_SVC_SENSOR_ID])
     cg.add(var.set_sensor(parent))
 
-CONFIG_SCHEMA = (
+def _power_of_two(value):
+    value = cv.int_range(min=0, max=1024)(value)
+    if value & (value - 1):
+        raise cv.Invalid(f"'{CONF_SAMPLE_FIFO}' must be a power of 2 (or 0 to disable it), got {value}")
+    return value
+
+def _validate_update_mode(config):
+    if not config[CONF_UPDATE_ON_CHANGE] and config[CONF_UPDATE_INTERVAL] == SCHEDULER_DONT_RUN:
+        raise cv.Invalid(
+            f"Set '{CONF_UPDATE_INTERVAL}' when '{CONF_UPDATE_ON_CHANGE}' is disabled, otherwise the registry is never updated"
+        )
+    return config
+
+CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(I2CServiceSensorComponent),
-            cv.Required(CONF_I2C_REG_KEY): cv.hex_uint8_t,
+            cv.Required(CONF_I2C_REG_KEY): i2c_slave.i2c_registry_key,
+            cv.Optional(CONF_UPDATE_ON_CHANGE, default=True): cv.boolean,
+            cv.Optional(CONF_SAMPLE_FIFO, default=0): _power_of_two,
+            cv.Optional(CONF_AGGREGATE, default=False): cv.boolean,
         }
     )
-    .extend(cv.polling_component_schema("10s"))
+    .extend(cv.polling_component_schema("never"))
+    .extend(i2c_slave.register_type_schema())
     .extend(i2c_slave.i2c_slave_device_schema())
-    .extend(i2c_service_sensor_schema())
+    .extend(i2c_service_sensor_schema()),
+    _validate_update_mode,
 )
 
 async def to_code(config):
@@ -60,4 +84,8 @@ async def to_code(config):
     await register_i2c_service_sensor(var, config)
 
     cg.add(var.set_registry_key(config[CONF_I2C_REG_KEY]))
+    cg.add(var.set_update_on_change(config[CONF_UPDATE_ON_CHANGE]))
+    cg.add(var.set_sample_fifo(config[CONF_SAMPLE_FIFO]))
+    cg.add(var.set_aggregate(config[CONF_AGGREGATE]))
+    cg.add(var.set_register_type(config[i2c_slave.CONF_REGISTER_TYPE]))
 
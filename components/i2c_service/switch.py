@@ -18,8 +18,7 @@ CONF_SWITCH = "switch"
 ICON_TOGGLE = "mdi:toggle-switch"
 
 i2c_service_ns = cg.esphome_ns.namespace("i2c_service")
-# I2CServiceSwitchComponent = i2c_service_ns.class_("I2CServiceSwitchComponent", cg.Component, i2c_slave.I2CSlaveDevice)
-I2CServiceSwitchComponent = i2c_service_ns.class_("I2CServiceSwitchComponent", cg.PollingComponent, i2c_slave.I2CSlaveDevice)
+I2CServiceSwitchComponent = i2c_service_ns.class_("I2CServiceSwitchComponent", cg.Component, i2c_slave.I2CSlaveDevice)
 
 def i2c_service_switch_schema():
     """Create a schema for a switch to be registered as i2c slave.
@@ -43,13 +42,13 @@ CONFIG_SCHEMA = (
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(I2CServiceSwitchComponent),
-            cv.Required(CONF_I2C_REG_KEY_READ): cv.hex_uint8_t,
-            cv.Required(CONF_I2C_REG_KEY_TURNON): cv.hex_uint8_t,
-            cv.Required(CONF_I2C_REG_KEY_TURNOFF): cv.hex_uint8_t,
+            cv.Required(CONF_I2C_REG_KEY_READ): i2c_slave.i2c_registry_key,
+            cv.Required(CONF_I2C_REG_KEY_TURNON): i2c_slave.i2c_registry_key,
+            cv.Required(CONF_I2C_REG_KEY_TURNOFF): i2c_slave.i2c_registry_key,
         }
     )
-    # .extend(cv.COMPONENT_SCHEMA)
-    .extend(cv.polling_component_schema("10s"))
+    .extend(cv.COMPONENT_SCHEMA)
+    .extend(i2c_slave.register_type_schema())
     .extend(i2c_slave.i2c_slave_device_schema())
     .extend(i2c_service_switch_schema())
 )
@@ -64,4 +63,5 @@ async def to_code(config):
     cg.add(var.set_registry_key_read(config[CONF_I2C_REG_KEY_READ]))
     cg.add(var.set_registry_key_turnon(config[CONF_I2C_REG_KEY_TURNON]))
     cg.add(var.set_registry_key_turnoff(config[CONF_I2C_REG_KEY_TURNOFF]))
+    cg.add(var.set_register_type(config[i2c_slave.CONF_REGISTER_TYPE]))
 
@@ -12,8 +12,18 @@ from esphome.const import (
     PLATFORM_ESP32,
 )
 from esphome.core import CORE, coroutine_with_priority
+from esphome.components.i2c_link import (  # noqa: F401, the register types and keys are shared with i2c_client
+    CONF_REGISTER_TYPE,
+    I2C_REG_KEY_MAX,
+    REGISTER_TYPES,
+    RegisterType,
+    i2c_registry_key,
+    register_type_schema,
+)
 
 CODEOWNERS = ["@pihiandreas"]
+AUTO_LOAD = ["i2c_link"]
+MULTI_CONF = True
 
 i2c_ns = cg.esphome_ns.namespace("i2c_slave")
 I2CSlave = i2c_ns.class_("I2CSlave")
@@ -21,6 +31,9 @@ IDFI2CSlave = i2c_ns.class_("IDFI2CSlave", I2CSlave, cg.Component)
 I2CSlaveDevice = i2c_ns.class_("I2CSlaveDevice")
 
 CONF_I2C_SLAVE_ID = "i2c_slave_id"
+CONF_FAST_PATH = "fast_path"
+CONF_ALERT_PIN = "alert_pin"
+
 
 def _slave_declare_type(value):
     if CORE.using_esp_idf:
@@ -40,6 +53,8 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_SDA, default="SDA"): pin_with_input_and_output_support,
             cv.Optional(CONF_SCL, default="SCL"): pin_with_input_and_output_support,
             cv.Required(CONF_ADDRESS): cv.i2c_address,
+            cv.Optional(CONF_FAST_PATH, default=False): cv.boolean,
+            cv.Optional(CONF_ALERT_PIN): pins.internal_gpio_output_pin_schema,
         }
     ).extend(cv.COMPONENT_SCHEMA),
     cv.only_on([PLATFORM_ESP32]),
@@ -54,6 +69,10 @@ async def to_code(config):
     cg.add(var.set_sda_pin(config[CONF_SDA]))
     cg.add(var.set_scl_pin(config[CONF_SCL]))
     cg.add(var.set_i2c_address(config[CONF_ADDRESS]))
+    cg.add(var.set_fast_path(config[CONF_FAST_PATH]))
+    if CONF_ALERT_PIN in config:
+        alert_pin = await cg.gpio_pin_expression(config[CONF_ALERT_PIN])
+        cg.add(var.set_alert_pin(alert_pin))
 
 def i2c_slave_device_schema():
     """Create a schema for a i2c slave device.
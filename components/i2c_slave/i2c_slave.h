@@ -1,9 +1,13 @@
 #pragma once
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <utility>
-#include <map>
+#include <atomic>
 #include <functional>
+#include <cmath>
+#include <limits>
+#include "../i2c_link/i2c_link.h"
 
 namespace esphome
 {
@@ -23,25 +27,402 @@ namespace i2c_slave
     ERROR_CRC = 7,              ///< bytes received with a CRC error
   };
 
-  typedef union value_u
+  /// @brief link commands, these keys are reserved and can't be used as registry keys
+  static const uint8_t I2C_SLAVE_CMD_BURST_READ = 0xF0; ///< [cmd, start_key, count]: reply with count consecutive registers
+  static const uint8_t I2C_SLAVE_CMD_DIRTY_READ = 0xF1; ///< [cmd]: reply with the changed-registers bitmap and clear it
+  static const uint8_t I2C_SLAVE_CMD_DRAIN = 0xF2;      ///< [cmd, key, max_count]: reply with the oldest samples of key
+  static const uint8_t I2C_SLAVE_CMD_AGGREGATE = 0xF3;  ///< [cmd, key]: reply with the aggregates of key and restart them
+  static const uint8_t I2C_SLAVE_CMD_STATUS = 0xF4;     ///< [cmd]: reply with the status word, the master measures the turnaround with it
+  static const uint8_t I2C_SLAVE_STATUS_READY = 0xA5;   ///< first byte of the status word, the reply is prepared
+  static const uint8_t I2C_SLAVE_REG_KEY_MAX = 0xEF;    ///< highest key available for registries
+
+  // register types and value encoding, shared with the other end of the link
+  using i2c_link::RegisterType;
+  using i2c_link::REG_TYPE_FLOAT;
+  using i2c_link::REG_TYPE_U8;
+  using i2c_link::REG_TYPE_I16;
+  using i2c_link::REG_TYPE_U32;
+  using i2c_link::REG_TYPE_I64;
+  using i2c_link::REG_TYPE_DOUBLE;
+  using i2c_link::I2C_REG_SIZE_MAX;
+  using i2c_link::value_t;
+  using i2c_link::register_type_size;
+  using i2c_link::encode_value;
+  using i2c_link::encode_integer;
+  using i2c_link::decode_value;
+
+  /// @brief Double-buffered seqlock: one writer publishes new versions, readers always get a consistent snapshot.
+  /// @note The writer fills the slot that is not published and then flips the sequence counter, so a reader only has
+  /// to retry when the writer published twice while it was copying. Neither side ever blocks, load() is forced
+  /// inline so it can be used from the ISR callbacks: its retries are bounded, it reports a copy it couldn't verify
+  /// instead of spinning, and the caller falls back. Only a single writer (the main loop) is supported.
+  template<typename T> class SeqLocked
+  {
+  public:
+    /// @brief publish a new version (writer only)
+    void store(const T &value)
+    {
+      uint32_t seq = seq_.load(std::memory_order_relaxed);
+      seq_.store(seq + 1, std::memory_order_relaxed); // odd: writing the unpublished slot
+      std::atomic_thread_fence(std::memory_order_release);
+      slot_[((seq >> 1) + 1) & 1] = value;
+      seq_.store(seq + 2, std::memory_order_release); // even: the slot just written is published
+    }
+
+    /// @brief copy the last published version into value
+    /// @return false if the writer published faster than the copy could be verified within MAX_RETRIES, value may
+    /// then be torn and must not be used
+    inline __attribute__((always_inline)) bool load(T &value) const
+    {
+      for (uint8_t retry = 0; retry < MAX_RETRIES; retry++)
+      {
+        uint32_t seq = seq_.load(std::memory_order_acquire);
+        value = slot_[(seq >> 1) & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the slot we read is only rewritten once the writer starts the second version after seq
+        if (seq_.load(std::memory_order_relaxed) - (seq & ~1U) < 3)
+          return true;
+      }
+      return false;
+    }
+
+    /// @brief the last published version (writer only, it can't race its own stores)
+    const T &latest() const { return slot_[(seq_.load(std::memory_order_relaxed) >> 1) & 1]; }
+
+    /// @brief number of versions published so far
+    uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+  protected:
+    static const uint8_t MAX_RETRIES = 4; // bounded, a reader in an ISR must never spin on a busy writer
+    std::atomic<uint32_t> seq_{0};        // odd while the writer fills a slot
+    T slot_[2]{};                         // published slot is (seq_ >> 1) & 1
+  };
+
+  /// @brief longest payload the master can write after a registry key in one transaction
+  static const size_t I2C_SLAVE_MAX_PAYLOAD = 32;
+
+  /// @brief a master write: registry key and (optional) payload
+  typedef struct
   {
-    float value_fl;
-    uint8_t value_raw[4];
-  } value_t;
+    uint8_t reg_key;
+    uint8_t len;                             // payload length, 0 if the master only wrote the key
+    uint8_t data[I2C_SLAVE_MAX_PAYLOAD];
+  } i2c_slave_write_t;
 
-  // signature for callback function
+  // signature for callback function, data/len is the payload written after the registry key (len = 0 if none)
   // typedef void (*i2c_slave_callback_t)(void *arg);
-  typedef void (*i2c_slave_callback_t)(uint8_t reg_key, void *arg);
+  typedef void (*i2c_slave_callback_t)(uint8_t reg_key, const uint8_t *data, size_t len, void *arg);
+
+  /// @brief Lock-free single-producer/single-consumer ring buffer.
+  /// @note Exactly one task pushes and exactly one other task pops (either may be an ISR), neither side ever blocks.
+  /// The buffer is allocated once by init() during setup, before the producer and consumer start.
+  template<typename T> class SPSCRing
+  {
+  public:
+    /// @brief allocate the buffer
+    /// @param capacity number of items, must be a power of 2
+    void init(size_t capacity)
+    {
+      buf_ = new T[capacity];
+      mask_ = capacity - 1;
+    }
+
+    /// @brief append an item (producer only)
+    /// @return false if the ring is full (or not initialized)
+    inline __attribute__((always_inline)) bool push(const T &item)
+    {
+      size_t head = head_.load(std::memory_order_relaxed);
+      if (buf_ == nullptr || head - tail_.load(std::memory_order_acquire) > mask_)
+        return false;
+      buf_[head & mask_] = item;
+      head_.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// @brief take the oldest item (consumer only)
+    /// @return false if the ring is empty
+    inline __attribute__((always_inline)) bool pop(T &item)
+    {
+      size_t tail = tail_.load(std::memory_order_relaxed);
+      if (head_.load(std::memory_order_acquire) == tail)
+        return false;
+      item = buf_[tail & mask_];
+      tail_.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// @brief number of items waiting, exact for the consumer
+    inline __attribute__((always_inline)) size_t size() const
+    {
+      return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+
+  protected:
+    T *buf_{nullptr};
+    size_t mask_{0};              // capacity - 1
+    std::atomic<size_t> head_{0}; // written by the producer
+    std::atomic<size_t> tail_{0}; // written by the consumer
+  };
+
+  /// @brief max size of a drain reply: a 4 byte header [count, remaining, dropped, 0] and count samples, each a 4 byte
+  /// timestamp and the value with the size of the registry's type, padded with zeros to a multiple of 4 bytes
+  static const size_t I2C_SLAVE_DRAIN_MAX = 64;
+
+  /// @brief a timestamped value in the sample history of a registry
+  typedef struct
+  {
+    uint32_t timestamp; // ms since boot of the slave
+    value_t value;
+  } i2c_slave_sample_t;
+
+  /// @brief sample history of a registry, filled by the main loop and drained by the master (from the ISR)
+  typedef struct
+  {
+    SPSCRing<i2c_slave_sample_t> samples;
+    std::atomic<uint32_t> dropped{0}; // samples lost because the history was full, since the last drain
+  } i2c_slave_fifo_t;
+
+  /// @brief aggregates of the samples of a registry since the master last read them (wire format of the reply)
+  typedef struct
+  {
+    float min;
+    float max;
+    float mean;
+    float last;
+    uint32_t count; // number of samples in the window, 0 if none (min/max/mean are 0 then, last is kept)
+  } i2c_slave_aggregate_t;
+
+  /// @brief Rolling min/max/mean/last/count of a registry's samples, restarted whenever the master reads them.
+  /// @note The main loop adds samples and publishes a numbered snapshot through a seqlock after each one. The receive
+  /// ISR takes the published snapshot and marks it consumed in the same atomic step, a second read before the next
+  /// snapshot gets count = 0. The main loop restarts the window once it sees the mark, keeping the sample that was
+  /// added after the taken snapshot. A read that lands while the main loop publishes also gets count = 0, its samples
+  /// stay in the window for the next read: nothing is reported twice or lost.
+  class I2CSlaveAggregator
+  {
+  public:
+    /// @brief add a sample (main loop only)
+    void add(float val)
+    {
+      if (count_ == 0 || val < min_)
+        min_ = val;
+      if (count_ == 0 || val > max_)
+        max_ = val;
+      sum_ += val;
+      last_ = val;
+      count_++;
+      publish_();
+    }
+
+    /// @brief restart the window if the master took it (main loop only)
+    void poll()
+    {
+      if (state_.load(std::memory_order_acquire) & STATE_TAKEN)
+        publish_();
+    }
+
+    /// @brief take the aggregates for the master and mark them consumed, the window is restarted by the main loop
+    /// (ISR)
+    inline __attribute__((always_inline)) i2c_slave_aggregate_t take()
+    {
+      snapshot_t snapshot;
+      if (!snapshot_.load(snapshot))
+        return i2c_slave_aggregate_t{}; // torn copy: nothing is marked, the samples come with the next read
+      uint32_t state = state_.load(std::memory_order_acquire);
+      // consumed, or the main loop is publishing a newer one: an empty window, the samples come with the next read
+      if ((state & STATE_TAKEN) || snapshot.gen != state >> 1 ||
+          !state_.compare_exchange_strong(state, state | STATE_TAKEN, std::memory_order_acq_rel))
+      {
+        i2c_slave_aggregate_t empty{};
+        empty.last = snapshot.aggregate.last;
+        return empty;
+      }
+      return snapshot.aggregate;
+    }
+
+  protected:
+    typedef struct
+    {
+      i2c_slave_aggregate_t aggregate;
+      uint32_t gen; // number of the snapshot, matches state_ >> 1 once published
+    } snapshot_t;
+
+    static const uint32_t STATE_TAKEN = 1; // state_: (number of the published snapshot << 1) | taken
+
+    // window restart after the master took the published snapshot: keep the sample added since (at most one, every
+    // sample is published)
+    void restart_()
+    {
+      bool unseen = count_ != published_count_;
+      count_ = 0;
+      sum_ = 0.0;
+      if (unseen)
+      {
+        min_ = max_ = last_;
+        sum_ = last_;
+        count_ = 1;
+      }
+    }
+
+    snapshot_t snapshot_of_window_() const
+    {
+      snapshot_t snapshot{};
+      snapshot.gen = gen_ + 1;
+      snapshot.aggregate.last = last_;
+      snapshot.aggregate.count = count_;
+      if (count_ > 0)
+      {
+        snapshot.aggregate.min = min_;
+        snapshot.aggregate.max = max_;
+        snapshot.aggregate.mean = (float) (sum_ / count_);
+      }
+      return snapshot;
+    }
+
+    void publish_()
+    {
+      uint32_t state = state_.load(std::memory_order_acquire);
+      if (state & STATE_TAKEN)
+        restart_();
+      snapshot_.store(snapshot_of_window_());
+      if (!state_.compare_exchange_strong(state, (gen_ + 1) << 1, std::memory_order_acq_rel))
+      {
+        // the master took the previous snapshot while this one was built, its samples are in this one as well.
+        // The ISR doesn't take a snapshot that is newer than the state, so this one was never sent.
+        restart_();
+        snapshot_.store(snapshot_of_window_());
+        state_.store((gen_ + 1) << 1, std::memory_order_release);
+      }
+      gen_++;
+      published_count_ = count_;
+    }
+
+    // window state, main loop only
+    float min_{0.0f};
+    float max_{0.0f};
+    double sum_{0.0};
+    float last_{0.0f};
+    uint32_t count_{0};
+    uint32_t published_count_{0}; // count_ of the published snapshot
+    uint32_t gen_{0};             // number of the published snapshot
+
+    SeqLocked<snapshot_t> snapshot_;  // published after every change, read by the ISR
+    std::atomic<uint32_t> state_{0};  // written by the main loop (publish) and the ISR (taken mark)
+  };
 
   typedef struct
   {
-    value_t val;              // val = value_t (union)
+    SeqLocked<value_t> val;   // val = value_t (union), published by the main loop, read by the slave task/ISR
     i2c_slave_callback_t cb;  // callback = func
     void *svc_handle;         // pointer to whole object (not only pointer to static member function)
+    RegisterType type;        // type of val
+    uint8_t size;             // bytes of val sent on the bus, follows the type
+    i2c_slave_fifo_t *fifo;   // optional sample history, nullptr if not enabled
+    I2CSlaveAggregator *agg;  // optional aggregates, nullptr if not enabled
   } reg_val_t;
 
+  /// @brief number of registry slots, one for every possible 8 bit registry key
+  static const size_t I2C_SLAVE_REG_COUNT = 256;
+
+  /// @brief Flat key/value store with one slot per 8 bit registry key and a presence bitmap.
+  /// @note All slots are part of the object itself, so there are no allocations after construction and every lookup
+  /// is a constant time index operation that is safe to call from the i2c slave task or an ISR. The lookup methods are
+  /// forced inline so they end up in IRAM together with the ISR callbacks that use them.
+  class I2CSlaveRegistry
+  {
+  public:
+    /// @brief check if a registry key has been registered
+    inline __attribute__((always_inline)) bool contains(uint8_t key) const
+    {
+      return (present_[key >> 5].load(std::memory_order_acquire) >> (key & 0x1F)) & 1;
+    }
+
+    /// @brief lookup a registry entry
+    /// @return pointer to the entry, or nullptr if the key is not registered
+    inline __attribute__((always_inline)) reg_val_t *find(uint8_t key) { return contains(key) ? &regs_[key] : nullptr; }
+
+    /// @brief register a key (if not registered yet), the slot is cleared before it is marked as present
+    /// @return pointer to the entry
+    reg_val_t *insert(uint8_t key)
+    {
+      if (!contains(key))
+      {
+        regs_[key].val.store(value_t{});
+        regs_[key].cb = NULL;
+        regs_[key].svc_handle = nullptr;
+        regs_[key].type = REG_TYPE_FLOAT;
+        regs_[key].size = register_type_size(REG_TYPE_FLOAT);
+        regs_[key].fifo = nullptr;
+        regs_[key].agg = nullptr;
+        present_[key >> 5].fetch_or(1UL << (key & 0x1F), std::memory_order_release);
+        mark_dirty(key); // the master hasn't seen the new key yet
+      }
+      return &regs_[key];
+    }
+
+    /// @brief flag a registry value as changed since the master last read the dirty bitmap
+    void mark_dirty(uint8_t key) { dirty_[key >> 5].fetch_or(1UL << (key & 0x1F), std::memory_order_release); }
+
+    /// @brief take the dirty bitmap (bit n of word n / 32 = key n) and clear it, in one atomic step per word
+    inline __attribute__((always_inline)) void take_dirty(uint32_t *bits)
+    {
+      for (size_t n = 0; n < I2C_SLAVE_REG_COUNT / 32; n++)
+        bits[n] = dirty_[n].exchange(0, std::memory_order_acq_rel);
+    }
+
+    /// @brief check if any registry value changed since the last dirty read
+    bool any_dirty() const
+    {
+      for (const auto &bits : dirty_)
+        if (bits.load(std::memory_order_relaxed) != 0)
+          return true;
+      return false;
+    }
+
+    /// @brief number of registered keys
+    size_t size() const
+    {
+      size_t n = 0;
+      for (const auto &bits : present_)
+        n += __builtin_popcount(bits.load(std::memory_order_relaxed));
+      return n;
+    }
+
+  protected:
+    reg_val_t regs_[I2C_SLAVE_REG_COUNT]{};                       // one slot per key
+    std::atomic<uint32_t> present_[I2C_SLAVE_REG_COUNT / 32]{};   // bit set = key registered
+    std::atomic<uint32_t> dirty_[I2C_SLAVE_REG_COUNT / 32]{};     // bit set = value changed since the last dirty read
+  };
+
+  /// @brief state of the alert line (open-drain, low = asserted): asserted by the main loop while the dirty bitmap
+  /// is non-empty, released by the dirty read itself (ISR) when it takes the bitmap
+  /// @note Releasing on the read means the master never finds the line still low from changes it already read, and
+  /// every change after the read asserts the line again with a new falling edge.
+  class I2CSlaveAlert
+  {
+  public:
+    /// @brief main loop: drive the line for the current dirty state, drive(level) sets the pin (true = released)
+    /// @note The line is driven before the new state is published, so the ISR only ever releases a line that is
+    /// low. If the read lands in between, the line stays low with an empty bitmap until the next update().
+    template<typename F> void update(bool dirty, F drive)
+    {
+      if (dirty == asserted_.load(std::memory_order_relaxed))
+        return;
+      drive(!dirty);
+      asserted_.store(dirty, std::memory_order_relaxed);
+    }
+
+    /// @brief dirty read (ISR), after the bitmap was taken: true if the line has to be released
+    inline __attribute__((always_inline)) bool release() { return asserted_.exchange(false, std::memory_order_relaxed); }
+
+    bool asserted() const { return asserted_.load(std::memory_order_relaxed); }
+
+  protected:
+    std::atomic<bool> asserted_{false};
+  };
+
   // registry type
-  typedef std::map<uint8_t, reg_val_t> i2c_slave_reg_t; // key = uint16_t, val = reg_val_t
+  typedef I2CSlaveRegistry i2c_slave_reg_t;
 
   /// @brief This Class provides the methods to setup the communication as a single i2c slave address on a bus.
   /// @note The I2CSlave virtual class follows a *Factory design pattern* that provides all the interfaces methods required
@@ -65,40 +446,127 @@ namespace i2c_slave
     /// @return the I2C address
     uint8_t get_i2c_address() const { return this->address_; }
 
-    void upsert_i2c_registry(uint8_t key, float val)
+    /// @brief set the type (and so the size on the bus) of a registry, registers it if needed
+    void set_type_i2c_registry(uint8_t key, RegisterType type)
     {
-      auto it = registry_.find(key);
-      if (it != registry_.end())
-        registry_[key].val.value_fl = val;
-      else
-        registry_.insert({key, {.val = {.value_fl = val}}});
+      reg_val_t *reg = registry_.insert(key);
+      reg->type = type;
+      reg->size = register_type_size(type);
+    };
+
+    /// @brief store a value, encoded as the registry's type (float if not set)
+    /// @note taken as a double, so u32 and double registers keep their precision (float has 24 bits)
+    void upsert_i2c_registry(uint8_t key, double val)
+    {
+      upsert_i2c_registry(key, encode_value(registry_.insert(key)->type, val));
+    };
+
+    /// @brief store an integer, encoded as the registry's type without a detour through floating point (i64)
+    template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    void upsert_i2c_registry(uint8_t key, T val)
+    {
+      upsert_i2c_registry(key, encode_integer(registry_.insert(key)->type, (int64_t) val));
+    };
+
+    /// @brief store an already encoded value (f.e. packed bits, that don't survive the float conversion)
+    void upsert_i2c_registry(uint8_t key, const value_t &value)
+    {
+      reg_val_t *reg = registry_.insert(key);
+      if (memcmp(reg->val.latest().value_raw, value.value_raw, sizeof(value.value_raw)) == 0)
+        return; // unchanged, the master doesn't need to fetch it again
+      reg->val.store(value);
+      registry_.mark_dirty(key);
+    };
+
+    /// @brief keep a history of timestamped samples for a registry, that the master drains in batches
+    /// @param capacity number of samples, must be a power of 2
+    void enable_fifo_i2c_registry(uint8_t key, size_t capacity)
+    {
+      reg_val_t *reg = registry_.insert(key);
+      if (reg->fifo != nullptr)
+        return;
+      i2c_slave_fifo_t *fifo = new i2c_slave_fifo_t;
+      fifo->samples.init(capacity);
+      reg->fifo = fifo;
+    };
+
+    /// @brief append a sample to the history of a registry (encoded as the registry's type)
+    /// @return false if the registry has no history or it is full, the sample is counted as dropped then
+    bool push_sample_i2c_registry(uint8_t key, uint32_t timestamp, double val)
+    {
+      reg_val_t *reg = registry_.find(key);
+      if (reg == nullptr || reg->fifo == nullptr)
+        return false;
+      if (!reg->fifo->samples.push({timestamp, encode_value(reg->type, val)}))
+      {
+        reg->fifo->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      return true;
+    };
+
+    /// @brief keep min/max/mean/last/count of the samples of a registry, that the master reads (and restarts)
+    void enable_aggregate_i2c_registry(uint8_t key)
+    {
+      reg_val_t *reg = registry_.insert(key);
+      if (reg->agg == nullptr)
+        reg->agg = new I2CSlaveAggregator;
+    };
+
+    /// @brief add a sample to the aggregates of a registry (main loop only)
+    void add_aggregate_i2c_registry(uint8_t key, float val)
+    {
+      reg_val_t *reg = registry_.find(key);
+      if (reg != nullptr && reg->agg != nullptr)
+        reg->agg->add(val);
+    };
+
+    /// @brief restart the aggregates of a registry if the master read them (main loop only)
+    void poll_aggregate_i2c_registry(uint8_t key)
+    {
+      reg_val_t *reg = registry_.find(key);
+      if (reg != nullptr && reg->agg != nullptr)
+        reg->agg->poll();
     };
 
     void set_cb_i2c_registry(uint8_t key, i2c_slave_callback_t f, void *svc_handle)
     {
-      auto it = registry_.find(key);
-      if (it != registry_.end()) {
-        registry_[key].cb = f;
-        registry_[key].svc_handle = svc_handle;
+      reg_val_t *reg = registry_.find(key);
+      if (reg != nullptr) {
+        reg->cb = f;
+        reg->svc_handle = svc_handle;
       }
     };
 
-    float read_i2c_registry(uint8_t key)
+    /// @brief store a payload written by the master in a registered key (zero padded to the value size)
+    /// @return false if the key is not registered
+    bool write_i2c_registry(uint8_t key, const uint8_t *data, size_t len)
     {
-      auto it = registry_.find(key);
-      if (it != registry_.end())
-        return registry_[key].val.value_fl;
+      reg_val_t *reg = registry_.find(key);
+      if (reg == nullptr)
+        return false;
+      value_t value{};
+      memcpy(value.value_raw, data, len < reg->size ? len : reg->size);
+      if (memcmp(reg->val.latest().value_raw, value.value_raw, sizeof(value.value_raw)) != 0)
+      {
+        reg->val.store(value);
+        registry_.mark_dirty(key);
+      }
+      return true;
+    }
+
+    double read_i2c_registry(uint8_t key)
+    {
+      reg_val_t *reg = registry_.find(key);
+      if (reg != nullptr)
+        return decode_value(reg->type, reg->val.latest());
       else
-        return 0.0f;
+        return 0.0;
     }; // TODO: don't return 0.0 if key not existing
 
     reg_val_t *get_i2c_registry(uint8_t key)
     {
-      auto it = registry_.find(key);
-      if (it != registry_.end())
-        return &registry_[key];
-      else
-        return NULL;
+      return registry_.find(key);
     };
 
   protected:
@@ -3,20 +3,22 @@
 #include "i2c_slave_esp_idf.h"
 #include <cinttypes>
 #include <cstring>
-#include <map>
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
 #include <freertos/task.h>
 #include "esp_event.h"
 #include "driver/i2c_slave.h"
+#include "hal/i2c_ll.h"
+#include "soc/soc_caps.h"
+#include "esp_idf_version.h"
 
 // Command Lists
 #define FIRST_COMMAND (0x10)
 
-// #if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 3, 0)
-// #define SOC_HP_I2C_NUM SOC_I2C_NUM
-// #endif
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 3, 0)
+#define SOC_HP_I2C_NUM SOC_I2C_NUM
+#endif
 
 namespace esphome
 {
@@ -24,18 +26,29 @@ namespace i2c_slave
 {
   static const char *const TAG = "i2c_slave.idf";
 
-  typedef struct
+  typedef struct i2c_slave_context_t
   {
     QueueHandle_t event_queue;
-    uint8_t command_data;
+    uint8_t command_data;     // first byte of the last master write (registry key or link command)
+    uint8_t reg_ptr;          // register pointer, auto-increments while a reply is sent
+    uint16_t reg_remaining;   // registers left to send in the current reply
     i2c_slave_dev_handle_t handle;
     i2c_slave_reg_t *registry;
     void *svc_handle;
+    i2c_dev_t *hw;  // hardware registers, used by the fast path to fill the TX FIFO from the ISR
+    SPSCRing<i2c_slave_write_t> *cmd_events;  // master writes, stored and passed to the callbacks in loop()
+    std::atomic<uint32_t> *dropped_writes;
+    const uint8_t *reply_raw; // when set, the reply is sent from this buffer (4 bytes per register) instead of the registry
+    uint8_t reply_raw_words;  // size of reply_raw in 4 byte words, zeros are sent past the end
+    uint32_t dirty_bits[I2C_SLAVE_REG_COUNT / 32]; // dirty bitmap taken by the last dirty read command
+    uint32_t reply_buf[I2C_SLAVE_DRAIN_MAX / 4];    // reply of the last drain, aggregate or status command
+    I2CSlaveAlert *alert;     // released by the dirty read, nullptr without an alert pin
+    ISRInternalGPIOPin alert_pin;
+    bool fast_path;
   } i2c_slave_context_t;
 
   typedef enum
   {
-    I2C_SLAVE_EVT_RX,
     I2C_SLAVE_EVT_TX
   } i2c_slave_event_t;
 
@@ -44,9 +57,33 @@ namespace i2c_slave
   {
     ESP_LOGCONFIG(TAG, "Running setup");
 
-    static i2c_slave_context_t context = (i2c_slave_context_t){ .registry = &registry_ };
+    // every slave gets its own port, taken from the pool shared with the i2c master buses (see IDFI2CBus::setup)
+    int port = i2c_link::claim_i2c_port(SOC_HP_I2C_NUM);
+    if (port < 0)
+    {
+      ESP_LOGE(TAG, "No free I2C port, the chip has %u for all i2c buses and i2c slaves together", SOC_HP_I2C_NUM);
+      this->mark_failed();
+      return;
+    }
+    port_ = (i2c_port_t)port;
+
     // registry_.insert({ FIRST_COMMAND, 0x12345678 });
-    static i2c_port_t next_port = I2C_NUM_0;
+    context_ = new i2c_slave_context_t(); // NOLINT(cppcoreguidelines-owning-memory), lives as long as the component
+    i2c_slave_context_t &context = *context_;
+    context.registry = &registry_;
+    context.hw = I2C_LL_GET_HW(port_);
+    context.fast_path = fast_path_;
+    cmd_events_.init(16);
+    context.cmd_events = &cmd_events_;
+    context.dropped_writes = &dropped_writes_;
+
+    if (alert_pin_ != nullptr)
+    {
+      alert_pin_->setup();
+      alert_pin_->digital_write(true); // released, asserted (low) once a register changes
+      context.alert = &alert_;
+      context.alert_pin = alert_pin_->to_isr();
+    }
 
     // BUG(?): can't create new default event loop if f.e. wifi already defines it (see: wifi_component_esp_idf.cpp)
     // ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -69,7 +106,7 @@ namespace i2c_slave
     ESP_LOGCONFIG(TAG, "i2c_slave_param_config");
 
     i2c_slave_config_t i2c_slv_config = {
-        .i2c_port = next_port,
+        .i2c_port = port_,
         .sda_io_num = (gpio_num_t)sda_pin_,
         .scl_io_num = (gpio_num_t)scl_pin_,
         .clk_source = I2C_CLK_SRC_DEFAULT,
@@ -103,16 +140,114 @@ namespace i2c_slave
 
     ESP_LOGCONFIG(TAG, "i2c_slave_task_create");
 
-    xTaskCreate(i2c_slave_task_, "i2c_slave_task", 1024 * 4, &context, 10, NULL);
+    xTaskCreate(i2c_slave_task_, "i2c_slave_task", 1024 * 4, context_, 10, NULL);
 
     initialized_ = true;
 
     ESP_LOGCONFIG(TAG, "Setup successful");
   }
 
+  // Value of the register at the register pointer, from the raw reply buffer (4 bytes per register) or from the
+  // registry. Returns the number of bytes to send, a registry key that is not registered is sent as a zero float.
+  // A value the main loop rewrote faster than it could be copied is sent as zeros and flagged dirty again, so the
+  // master fetches it once more.
+  static inline __attribute__((always_inline)) uint8_t load_reply_value_(i2c_slave_context_t *context, value_t *value)
+  {
+    if (context->reply_raw != nullptr)
+    {
+      *value = value_t{};
+      if (context->reg_ptr < context->reply_raw_words)
+        memcpy(value->value_raw, context->reply_raw + context->reg_ptr * 4, 4);
+      return 4;
+    }
+    reg_val_t *reg_val = context->registry->find(context->reg_ptr);
+    if (reg_val == nullptr)
+    {
+      *value = value_t{};
+      return register_type_size(REG_TYPE_FLOAT);
+    }
+    if (!reg_val->val.load(*value)) // consistent snapshot, even while the main loop publishes
+    {
+      *value = value_t{};
+      context->registry->mark_dirty(context->reg_ptr);
+    }
+    return reg_val->size;
+  }
+
+  // Take up to max_count samples out of the history of a registry into the drain buffer:
+  // [count, remaining, dropped, 0] followed by count samples [timestamp (4 bytes), value (size of the type)].
+  // The reply is padded with zeros to the size of max_count samples, so it always has the length the master reads.
+  static inline __attribute__((always_inline)) void drain_fifo_(i2c_slave_context_t *context, uint8_t key, uint8_t max_count)
+  {
+    uint8_t *buf = (uint8_t *)context->reply_buf;
+    memset(buf, 0, sizeof(context->reply_buf));
+    size_t len = 4;
+    reg_val_t *reg_val = context->registry->find(key);
+    if (reg_val != nullptr && reg_val->fifo != nullptr)
+    {
+      size_t sample_size = 4 + reg_val->size;
+      if (max_count > (sizeof(context->reply_buf) - 4) / sample_size)
+        max_count = (sizeof(context->reply_buf) - 4) / sample_size;
+      uint8_t count = 0;
+      i2c_slave_sample_t sample;
+      while (count < max_count && reg_val->fifo->samples.pop(sample))
+      {
+        memcpy(buf + len, &sample.timestamp, 4);
+        memcpy(buf + len + 4, sample.value.value_raw, reg_val->size);
+        len += sample_size;
+        count++;
+      }
+      size_t remaining = reg_val->fifo->samples.size();
+      uint32_t dropped = reg_val->fifo->dropped.exchange(0, std::memory_order_relaxed);
+      buf[0] = count;
+      buf[1] = remaining > 255 ? 255 : remaining;
+      buf[2] = dropped > 255 ? 255 : dropped;
+      len = 4 + max_count * sample_size;
+    }
+    context->reply_raw_words = (len + 3) / 4;
+  }
+
+  // Fill the free space of the TX FIFO with the registers at the register pointer. The pointer auto-increments, so
+  // a burst longer than the FIFO continues on the next request event. The FIFO may still hold the start of the reply
+  // (prefilled by the receive callback), nothing is written once the whole reply is in.
+  static void IRAM_ATTR fill_txfifo_(i2c_slave_context_t *context)
+  {
+    uint32_t fifo_free = 0;
+    i2c_ll_get_txfifo_len(context->hw, &fifo_free);
+    // every register is sent with exactly the bytes of its type
+    value_t value{};
+    while (context->reg_remaining > 0)
+    {
+      uint8_t size = load_reply_value_(context, &value);
+      if (size > fifo_free)
+        break;
+      i2c_ll_write_txfifo(context->hw, value.value_raw, size);
+      fifo_free -= size;
+      context->reg_ptr++;
+      context->reg_remaining--;
+    }
+  }
+
   bool IRAM_ATTR IDFI2CSlave::i2c_slave_request_cb_(i2c_slave_dev_handle_t i2c_slave, const i2c_slave_request_event_data_t *evt_data, void *arg)
   {
     i2c_slave_context_t *context = (i2c_slave_context_t *)arg;
+    if (context->fast_path)
+    {
+      // Fast path: resolve the register(s) and put the value(s) in the TX FIFO right here,
+      // the master gets its reply without waiting for the slave task to be scheduled.
+      if (context->reg_remaining == 0)
+      {
+        // master reads past the end of the reply: zeros, one word per request like the slave task
+        uint32_t fifo_free = 0;
+        i2c_ll_get_txfifo_len(context->hw, &fifo_free);
+        const uint8_t zeros[4] = {};
+        if (fifo_free >= sizeof(zeros))
+          i2c_ll_write_txfifo(context->hw, zeros, sizeof(zeros));
+        return false;
+      }
+      fill_txfifo_(context);
+      return false;
+    }
     i2c_slave_event_t evt = I2C_SLAVE_EVT_TX;
     BaseType_t xTaskWoken = 0;
     xQueueSendFromISR(context->event_queue, &evt, &xTaskWoken);
@@ -122,22 +257,97 @@ namespace i2c_slave
   bool IRAM_ATTR IDFI2CSlave::i2c_slave_receive_cb_(i2c_slave_dev_handle_t i2c_slave, const i2c_slave_rx_done_event_data_t *evt_data, void *arg)
   {
     i2c_slave_context_t *context = (i2c_slave_context_t *)arg;
-    i2c_slave_event_t evt = I2C_SLAVE_EVT_RX;
-    BaseType_t xTaskWoken = 0;
-    // Command only contains one byte, so just save one bytes here.
+    if (evt_data->length == 0)
+      return false;
+    // First byte is the registry key (or a link command), set the register pointer for the reply.
     context->command_data = *evt_data->buffer;
-    xQueueSendFromISR(context->event_queue, &evt, &xTaskWoken);
-    return xTaskWoken;
+    if (context->command_data == I2C_SLAVE_CMD_BURST_READ && evt_data->length >= 3)
+    {
+      // [cmd, start_key, count]: reply with count consecutive registers
+      context->reg_ptr = evt_data->buffer[1];
+      context->reg_remaining = evt_data->buffer[2];
+      context->reply_raw = nullptr;
+    }
+    else if (context->command_data == I2C_SLAVE_CMD_DIRTY_READ)
+    {
+      // [cmd]: reply with the dirty bitmap, taken and cleared now so changes during the reply show up next time
+      context->registry->take_dirty(context->dirty_bits);
+      if (context->alert != nullptr && context->alert->release())
+        context->alert_pin.digital_write(true); // the master has the changes, loop() asserts again for new ones
+      context->reply_raw = (const uint8_t *)context->dirty_bits;
+      context->reply_raw_words = sizeof(context->dirty_bits) / 4;
+      context->reg_ptr = 0;
+      context->reg_remaining = context->reply_raw_words;
+    }
+    else if (context->command_data == I2C_SLAVE_CMD_STATUS)
+    {
+      // [cmd]: reply with the status word, the master reads it until it's there to learn this slave's turnaround
+      context->reply_buf[0] = I2C_SLAVE_STATUS_READY | (context->fast_path ? 0x100 : 0);
+      context->reply_raw = (const uint8_t *)context->reply_buf;
+      context->reply_raw_words = 1;
+      context->reg_ptr = 0;
+      context->reg_remaining = 1;
+    }
+    else if (context->command_data == I2C_SLAVE_CMD_DRAIN && evt_data->length >= 3)
+    {
+      // [cmd, key, max_count]: reply with the oldest samples of the key's history, taken out of it now
+      drain_fifo_(context, evt_data->buffer[1], evt_data->buffer[2]);
+      context->reply_raw = (const uint8_t *)context->reply_buf;
+      context->reg_ptr = 0;
+      context->reg_remaining = context->reply_raw_words;
+    }
+    else if (context->command_data == I2C_SLAVE_CMD_AGGREGATE && evt_data->length >= 2)
+    {
+      // [cmd, key]: reply with the aggregates since the last read, the main loop restarts them
+      reg_val_t *agg_reg = context->registry->find(evt_data->buffer[1]);
+      i2c_slave_aggregate_t aggregate{};
+      if (agg_reg != nullptr && agg_reg->agg != nullptr)
+        aggregate = agg_reg->agg->take();
+      memcpy(context->reply_buf, &aggregate, sizeof(aggregate));
+      context->reply_raw = (const uint8_t *)context->reply_buf;
+      context->reply_raw_words = sizeof(aggregate) / 4;
+      context->reg_ptr = 0;
+      context->reg_remaining = context->reply_raw_words;
+    }
+    else
+    {
+      context->reply_raw = nullptr;
+      context->reg_ptr = context->command_data;
+      context->reg_remaining = 1;
+    }
+    reg_val_t *reg_val = context->registry->find(context->command_data);
+    if (context->fast_path)
+    {
+      // Prefetch: drop whatever is left from an earlier reply and pre-load the requested
+      // register(s), so the reply is ready when the master reads after a repeated start.
+      i2c_ll_txfifo_rst(context->hw);
+      fill_txfifo_(context);
+    }
+    // A payload is stored in the register and a callback is run, both on the main loop: the registry has a single
+    // writer and callbacks touch components (f.e. switches). Plain register reads and link commands end here.
+    size_t len = evt_data->length - 1;
+    if (reg_val == nullptr || (len == 0 && reg_val->cb == NULL) || context->command_data > I2C_SLAVE_REG_KEY_MAX)
+      return false;
+    if (len > I2C_SLAVE_MAX_PAYLOAD)
+    {
+      context->dropped_writes->fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    i2c_slave_write_t write;
+    write.reg_key = context->command_data;
+    write.len = len;
+    memcpy(write.data, evt_data->buffer + 1, len);
+    if (!context->cmd_events->push(write))
+      context->dropped_writes->fetch_add(1, std::memory_order_relaxed);
+    return false;
   }
 
   void IDFI2CSlave::i2c_slave_task_(void *arg)
   {
     i2c_slave_context_t *context = (i2c_slave_context_t *)arg;
     i2c_slave_dev_handle_t handle = (i2c_slave_dev_handle_t)context->handle;
-    i2c_slave_reg_t *reg;
-    i2c_slave_reg_t::iterator reg_it;
 
-    uint8_t zero_buffer[32] = {}; // Use this buffer to clear the fifo.
+    uint8_t tx_buffer[SOC_I2C_FIFO_LEN];
     uint32_t write_len, total_written;
     uint32_t buffer_size = 0;
 
@@ -148,47 +358,49 @@ namespace i2c_slave
       {
         if (evt == I2C_SLAVE_EVT_TX)
         {
-          ESP_LOGW(TAG, "i2c_slave_request_event (RO/TX) received");
-
-          uint8_t *data_buffer;
-
-          reg = context->registry;
-
-          reg_it = reg->find(context->command_data); // lookup requested registry value
-          if (reg_it == reg->end()) { // we're past-the-end = not found
-            ESP_LOGE(TAG, "Non-existing registry value, 0x%02X, requested", context->command_data);
-            data_buffer = zero_buffer;
-            buffer_size = sizeof(zero_buffer);
-          } else {
-            ESP_LOGVV(TAG, "Sending reg(0x%02X): %.2f", reg_it->first, (reg_it->second).val.value_fl);
-            ESP_LOGVV(TAG, "Sending reg(0x%02X): 0x%02X 0x%02X 0x%02X 0x%02X", reg_it->first, (reg_it->second).val.value_raw[0], (reg_it->second).val.value_raw[1], (reg_it->second).val.value_raw[2], (reg_it->second).val.value_raw[3]);
-            ESP_LOGVV(TAG, "Sizeof union : %d", sizeof(reg_it->second).val);
-            data_buffer = (reg_it->second).val.value_raw;
-            buffer_size = 4;
+          ESP_LOGV(TAG, "i2c_slave_request_event (RO/TX) received");
+
+          if (context->reg_remaining == 0)
+          {
+            // master reads past the end of the reply: zeros, one word per request like the fast path
+            const uint8_t zeros[4] = {};
+            ESP_ERROR_CHECK(i2c_slave_write(handle, zeros, sizeof(zeros), &write_len, 1000));
+            continue;
           }
 
-          total_written = 0;
-          while (total_written < buffer_size)
+          // send the registers at the (auto-incrementing) register pointer, one FIFO sized chunk at a time
+          while (context->reg_remaining > 0)
           {
-            ESP_ERROR_CHECK(i2c_slave_write(handle, data_buffer + total_written, buffer_size - total_written, &write_len, 1000));
-            if (write_len == 0)
+            buffer_size = 0;
+            while (context->reg_remaining > 0)
             {
-              ESP_LOGE(TAG, "Write error or timeout");
-              break;
+              // every register is sent with exactly the bytes of its type
+              value_t value;
+              uint8_t size = load_reply_value_(context, &value);
+              if (buffer_size + size > sizeof(tx_buffer))
+                break;
+              if (context->reply_raw == nullptr && !context->registry->contains(context->reg_ptr)) { // not registered
+                ESP_LOGE(TAG, "Non-existing registry value, 0x%02X, requested", context->reg_ptr);
+              } else {
+                ESP_LOGVV(TAG, "Sending reg(0x%02X): %u bytes, 0x%02X 0x%02X 0x%02X 0x%02X ...", context->reg_ptr, size, value.value_raw[0], value.value_raw[1], value.value_raw[2], value.value_raw[3]);
+              }
+              memcpy(tx_buffer + buffer_size, value.value_raw, size);
+              buffer_size += size;
+              context->reg_ptr++;
+              context->reg_remaining--;
             }
-            total_written += write_len;
-          }
-        } else if (evt == I2C_SLAVE_EVT_RX) {
-          ESP_LOGW(TAG, "i2c_slave_receive_event (RW/RX) received");
-
-          reg = context->registry;
-          reg_it = reg->find(context->command_data); // lookup requested registry value
 
-          if (reg_it != reg->end() && (reg_it->second).cb != NULL) {
-            i2c_slave_callback_t cb = (reg_it->second).cb;
-            ESP_LOGVV(TAG, "Calling cb for (0x%02X): *f = %p", context->command_data, cb);
-              // call the callback (static member) function, give the pointer to the component object as parameter
-            cb(context->command_data, (void *)(reg_it->second).svc_handle);
+            total_written = 0;
+            while (total_written < buffer_size)
+            {
+              ESP_ERROR_CHECK(i2c_slave_write(handle, tx_buffer + total_written, buffer_size - total_written, &write_len, 1000));
+              if (write_len == 0)
+              {
+                ESP_LOGE(TAG, "Write error or timeout");
+                break;
+              }
+              total_written += write_len;
+            }
           }
         }
       }
@@ -196,12 +408,50 @@ namespace i2c_slave
     vTaskDelete(NULL);
   }
 
+  void IDFI2CSlave::loop()
+  {
+    i2c_slave_write_t write;
+    while (cmd_events_.pop(write))
+    {
+      ESP_LOGV(TAG, "Master write to 0x%02X, %u byte payload", write.reg_key, write.len);
+      if (write.len > 0)
+        write_i2c_registry(write.reg_key, write.data, write.len);
+      reg_val_t *reg_val = registry_.find(write.reg_key);
+      if (reg_val != nullptr && reg_val->cb != NULL) {
+        i2c_slave_callback_t cb = reg_val->cb;
+        ESP_LOGVV(TAG, "Calling cb for (0x%02X): *f = %p", write.reg_key, cb);
+        // call the callback (static member) function, give the pointer to the component object as parameter
+        cb(write.reg_key, write.data, write.len, (void *)reg_val->svc_handle);
+      }
+    }
+
+    uint32_t dropped = dropped_writes_.load(std::memory_order_relaxed);
+    if (dropped != dropped_writes_logged_)
+    {
+      ESP_LOGW(TAG, "Dropped %u master write(s), queue full or payload too long", (unsigned)(dropped - dropped_writes_logged_));
+      dropped_writes_logged_ = dropped;
+    }
+
+    if (alert_pin_ != nullptr)
+    {
+      // assert while changes are waiting for the master, the dirty read releases the line again
+      alert_.update(registry_.any_dirty(), [this](bool level) { alert_pin_->digital_write(level); });
+    }
+  }
+
   void IDFI2CSlave::dump_config()
   {
     ESP_LOGCONFIG(TAG, "I2C SLAVE:");
+    if (this->port_ != I2C_NUM_MAX)
+      ESP_LOGCONFIG(TAG, "  Port: %d", (int)this->port_);
+    else
+      ESP_LOGCONFIG(TAG, "  Port: none, no free I2C port");
     ESP_LOGCONFIG(TAG, "  SDA Pin: GPIO%u", this->sda_pin_);
     ESP_LOGCONFIG(TAG, "  SCL Pin: GPIO%u", this->scl_pin_);
     ESP_LOGCONFIG(TAG, "  Address: 0x%02X", this->address_);
+    ESP_LOGCONFIG(TAG, "  Registry keys: %u", (unsigned) this->registry_.size());
+    ESP_LOGCONFIG(TAG, "  Fast path: %s", YESNO(this->fast_path_));
+    LOG_PIN("  Alert Pin: ", this->alert_pin_);
     ESP_LOGCONFIG(TAG, "  Initialized: %u", this->initialized_);
   }
 
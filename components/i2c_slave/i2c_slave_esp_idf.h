@@ -4,6 +4,7 @@
 
 #include "i2c_slave.h"
 #include "esphome/core/component.h"
+#include "esphome/core/hal.h"
 #include "driver/i2c_types.h"
 
 namespace esphome
@@ -11,17 +12,35 @@ namespace esphome
 namespace i2c_slave
 {
 
+  struct i2c_slave_context_t;
+
   class IDFI2CSlave : public I2CSlave, public Component
   {
     public:
       void setup() override;
+      void loop() override;
       void dump_config() override;
       float get_setup_priority() const override { return setup_priority::BUS; }
 
+      /// @brief answer master read requests directly from the ISR instead of the slave task
+      void set_fast_path(bool fast_path) { fast_path_ = fast_path; }
+
+      /// @brief open-drain line pulled low while any register changed since the master's last dirty read
+      void set_alert_pin(InternalGPIOPin *alert_pin) { alert_pin_ = alert_pin; }
+
     protected:
-      i2c_port_t port_;
+      i2c_port_t port_{I2C_NUM_MAX}; ///< I2C_NUM_MAX until setup() claimed a port
+      /// state shared with the ISRs and the slave task, one per instance (and port)
+      i2c_slave_context_t *context_{nullptr};
       uint32_t timeout_ = 0;
       bool initialized_ = false;
+      bool fast_path_ = false;
+      InternalGPIOPin *alert_pin_{nullptr};
+      I2CSlaveAlert alert_;
+      /// master writes (payloads and writes to registries with a callback), handed from the receive ISR to loop()
+      SPSCRing<i2c_slave_write_t> cmd_events_;
+      std::atomic<uint32_t> dropped_writes_{0}; ///< master writes lost because cmd_events_ was full
+      uint32_t dropped_writes_logged_ = 0;
 
     private:
       static bool i2c_slave_request_cb_(i2c_slave_dev_handle_t i2c_slave, const i2c_slave_request_event_data_t *evt_data, void *arg);
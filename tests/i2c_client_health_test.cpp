@@ -0,0 +1,100 @@
+// Host test of the per-slave circuit breaker of i2c_client (HealthBreaker, run by DeviceHealth):
+// - a slave goes down after I2C_HEALTH_FAILURES consecutive failures,
+// - the polls that were already queued or in flight when it went down fail as well, they must not move the first
+//   probe past I2C_HEALTH_BACKOFF_MIN_MS,
+// - only a failed probe doubles the backoff (up to I2C_HEALTH_BACKOFF_MAX_MS), a successful one closes the breaker.
+//
+//   g++ -std=c++17 -O2 -Wall -Wextra -I components/i2c_client tests/i2c_client_health_test.cpp -o health_test
+//   ./health_test
+
+#include "i2c_client_state.h"
+
+#include <cstdio>
+
+using namespace esphome::i2c_client;
+
+namespace
+{
+  int failures = 0;
+
+  void check(bool ok, const char *what)
+  {
+    printf("  %s: %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+      failures++;
+  }
+
+  // the slave drops while a full update (8 burst reads) is queued on the bus worker
+  void failures_in_flight()
+  {
+    printf("failures in flight:\n");
+    HealthBreaker breaker;
+    uint32_t now = 5000;
+    bool sent = true;
+    for (int i = 0; i < 8; i++)
+      sent = breaker.allow_poll(now) && sent;
+    check(sent, "polls sent while the slave is up");
+    for (int i = 0; i < 8; i++)
+      breaker.record(false, now + i); // one failure per transaction timeout
+    uint32_t down_at = now + I2C_HEALTH_FAILURES - 1;
+    check(breaker.get_state() == HealthBreaker::STATE_DOWN, "slave is down");
+    check(breaker.get_failures() == 8, "every failure is counted");
+    check(breaker.get_backoff_ms() == I2C_HEALTH_BACKOFF_MIN_MS, "failures in flight don't double the backoff");
+    check(!breaker.allow_poll(down_at + I2C_HEALTH_BACKOFF_MIN_MS - 1), "no poll before the backoff passed");
+    check(breaker.allow_poll(down_at + I2C_HEALTH_BACKOFF_MIN_MS), "first probe after I2C_HEALTH_BACKOFF_MIN_MS");
+    check(!breaker.allow_poll(down_at + I2C_HEALTH_BACKOFF_MIN_MS), "a single probe at a time");
+  }
+
+  // every failed probe doubles the wait, up to the maximum, a successful one brings the slave back
+  void failed_probes()
+  {
+    printf("failed probes:\n");
+    HealthBreaker breaker;
+    uint32_t now = 0;
+    for (uint8_t i = 0; i < I2C_HEALTH_FAILURES; i++)
+      breaker.record(false, now);
+    uint32_t expected = I2C_HEALTH_BACKOFF_MIN_MS;
+    bool doubled = true;
+    for (int probe = 0; probe < 10; probe++)
+    {
+      now += breaker.get_backoff_ms();
+      if (!breaker.allow_poll(now))
+        doubled = false;
+      breaker.record(false, now);
+      expected = expected * 2 > I2C_HEALTH_BACKOFF_MAX_MS ? I2C_HEALTH_BACKOFF_MAX_MS : expected * 2;
+      if (breaker.get_backoff_ms() != expected)
+        doubled = false;
+    }
+    check(doubled, "every failed probe doubles the backoff");
+    check(breaker.get_backoff_ms() == I2C_HEALTH_BACKOFF_MAX_MS, "backoff capped at I2C_HEALTH_BACKOFF_MAX_MS");
+    now += breaker.get_backoff_ms();
+    check(breaker.allow_poll(now), "probe after the capped backoff");
+    breaker.record(true, now);
+    check(breaker.get_state() == HealthBreaker::STATE_UP, "successful probe brings the slave back");
+    check(breaker.allow_poll(now), "polls sent again");
+    for (uint8_t i = 0; i < I2C_HEALTH_FAILURES; i++)
+      breaker.record(false, now);
+    check(breaker.get_backoff_ms() == I2C_HEALTH_BACKOFF_MIN_MS, "the next outage starts with the minimum backoff");
+  }
+
+  // a probe that never reports (f.e. its transaction was dropped) is replaced after the backoff
+  void lost_probe()
+  {
+    printf("lost probe:\n");
+    HealthBreaker breaker;
+    for (uint8_t i = 0; i < I2C_HEALTH_FAILURES; i++)
+      breaker.record(false, 0);
+    check(breaker.allow_poll(I2C_HEALTH_BACKOFF_MIN_MS), "probe let through");
+    check(!breaker.allow_poll(2 * I2C_HEALTH_BACKOFF_MIN_MS - 1), "no second probe while the first may report");
+    check(breaker.allow_poll(2 * I2C_HEALTH_BACKOFF_MIN_MS), "new probe after another backoff");
+  }
+} // namespace
+
+int main()
+{
+  failures_in_flight();
+  failed_probes();
+  lost_probe();
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+// Host simulation of the alert path between an i2c_slave and an i2c_client hub. It runs the real state machines:
+// the slave registry and I2CSlaveAlert (i2c_slave.h) and the hub's AlertTrigger (i2c_client_state.h). The glue
+// around them mirrors IDFI2CSlave::loop() / the dirty read of the receive ISR, and I2CClientComponent::loop() /
+// update() / on_dirty_done_():
+// - the slave's loop() pulls the open-drain alert line low while its dirty bitmap is non-empty,
+// - the hub's dirty read takes and clears the bitmap and releases the line in the same step (ISR),
+// - the hub starts an update on a falling edge (pin ISR), or on the level when AlertTrigger allows it.
+// The hub's loop runs far more often than the slave's in most scenarios: the slave's loop runs late.
+//
+//   g++ -std=c++17 -O2 -Wall -Wextra -I components/i2c_slave -I components/i2c_client tests/i2c_link_alert_sim.cpp -o alert_sim
+//   ./alert_sim
+
+#include "i2c_slave.h"
+#include "i2c_client_state.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <set>
+
+using esphome::i2c_client::AlertTrigger;
+using namespace esphome::i2c_slave;
+
+namespace
+{
+  int failures = 0;
+
+  void check(bool ok, const char *what)
+  {
+    printf("  %s: %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok)
+      failures++;
+  }
+
+  // open-drain line with a pull-up, a falling edge runs the hub's pin interrupt
+  struct AlertLine
+  {
+    bool level{true};
+    AlertTrigger *isr{nullptr};
+
+    void drive(bool high)
+    {
+      if (level && !high && isr != nullptr)
+        isr->on_edge();
+      level = high;
+    }
+  };
+
+  // the slave: real registry and alert state, glue of IDFI2CSlave
+  struct SimSlave : public I2CSlave
+  {
+    explicit SimSlave(AlertLine &line) : line(line) {}
+
+    AlertLine &line;
+    I2CSlaveAlert alert;
+    bool release_on_read{true}; // false: the line is only released by loop(), like a slave without the fix
+
+    void loop()
+    {
+      alert.update(registry_.any_dirty(), [this](bool level) { line.drive(level); });
+    }
+
+    // dirty read command, receive ISR
+    void dirty_read(uint32_t *bits)
+    {
+      registry_.take_dirty(bits);
+      if (release_on_read && alert.release())
+        line.drive(true);
+    }
+  };
+
+  // the hub with read_changed_only: real AlertTrigger, glue of I2CClientComponent. An update is the dirty read and
+  // the burst reads of the dirty keys, completed by complete()
+  struct SimHub
+  {
+    explicit SimHub(AlertLine &line) : line(line) { line.isr = &alert; }
+
+    AlertLine &line;
+    AlertTrigger alert;
+    bool pending{false};
+    uint32_t dirty[I2C_SLAVE_REG_COUNT / 32]{};
+    std::set<uint8_t> received;
+    int reads{0};
+    int empty_reads{0};
+
+    void loop(SimSlave &slave)
+    {
+      if (!pending && alert.poll(!line.level))
+      {
+        slave.dirty_read(dirty);
+        reads++;
+        pending = true;
+      }
+    }
+
+    void complete()
+    {
+      if (!pending)
+        return;
+      bool changed = std::any_of(std::begin(dirty), std::end(dirty), [](uint32_t bits) { return bits != 0; });
+      alert.on_dirty_read(changed);
+      if (!changed)
+        empty_reads++;
+      for (size_t key = 0; key < I2C_SLAVE_REG_COUNT; key++)
+        if ((dirty[key >> 5] >> (key & 0x1F)) & 1)
+          received.insert(key);
+      pending = false;
+    }
+
+    // many passes of the hub's loop while the slave's loop doesn't run
+    void spin(SimSlave &slave, int passes)
+    {
+      for (int i = 0; i < passes; i++)
+      {
+        loop(slave);
+        complete();
+      }
+    }
+  };
+
+  // a change is signalled, fetched, and the line released by the read itself
+  void single_change()
+  {
+    printf("single change, the slave's loop runs late:\n");
+    AlertLine line;
+    SimHub hub{line};
+    auto slave = std::make_unique<SimSlave>(line);
+    hub.spin(*slave, 1); // boot: line high, nothing to read
+    check(hub.reads == 0, "no read without an alert");
+    slave->upsert_i2c_registry(0x10, 1.0f);
+    slave->loop();
+    check(!line.level, "slave asserts the line on a change");
+    hub.loop(*slave);
+    check(hub.pending, "edge starts an update");
+    check(line.level, "dirty read releases the line");
+    hub.complete();
+    check(hub.received.count(0x10) == 1, "hub received the changed key");
+    hub.spin(*slave, 100);
+    check(hub.reads == 1 && hub.empty_reads == 0, "no more reads while the slave's loop is late");
+    slave->loop();
+    hub.spin(*slave, 100);
+    check(hub.reads == 1 && line.level, "line stays released");
+  }
+
+  // a change during an update: the read released the line, the slave's loop asserts it again with a new edge
+  void change_during_update()
+  {
+    printf("change during an update:\n");
+    AlertLine line;
+    SimHub hub{line};
+    auto slave = std::make_unique<SimSlave>(line);
+    slave->upsert_i2c_registry(0x10, 1.0f);
+    slave->loop();
+    hub.loop(*slave);
+    slave->upsert_i2c_registry(0x11, 2.0f);
+    slave->loop();
+    check(!line.level, "slave asserts the line for the new change");
+    hub.complete();
+    hub.spin(*slave, 100);
+    check(hub.received.count(0x11) == 1, "hub fetched the new change right away");
+    check(hub.reads == 2 && hub.empty_reads == 0, "one read per change, none empty");
+    check(line.level, "line released");
+  }
+
+  // a change the slave's loop hasn't flagged yet goes out with the read, the line doesn't stay low for it
+  void change_before_read()
+  {
+    printf("change before the read, flagged late:\n");
+    AlertLine line;
+    SimHub hub{line};
+    auto slave = std::make_unique<SimSlave>(line);
+    slave->upsert_i2c_registry(0x10, 1.0f);
+    slave->loop();
+    slave->upsert_i2c_registry(0x11, 2.0f);
+    hub.spin(*slave, 1);
+    check(hub.received.count(0x10) == 1 && hub.received.count(0x11) == 1, "both changes in one read");
+    slave->loop();
+    hub.spin(*slave, 100);
+    check(line.level && hub.reads == 1, "no alert for changes the hub already has");
+  }
+
+  // the read lands between the slave's loop driving the line and publishing the new state
+  void read_during_assert()
+  {
+    printf("read while the slave asserts the line:\n");
+    AlertLine line;
+    auto slave = std::make_unique<SimSlave>(line);
+    uint32_t bits[I2C_SLAVE_REG_COUNT / 32];
+    slave->upsert_i2c_registry(0x10, 1.0f);
+    slave->alert.update(true, [&](bool level) {
+      line.drive(level);
+      slave->dirty_read(bits);
+    });
+    check(!line.level, "line left low with an empty bitmap");
+    slave->loop();
+    check(line.level, "released by the slave's next loop");
+  }
+
+  // the hub starts while the line is already low: there is no edge, the level starts the first update
+  void low_at_start()
+  {
+    printf("line low when the hub starts:\n");
+    AlertLine line;
+    auto slave = std::make_unique<SimSlave>(line);
+    slave->upsert_i2c_registry(0x10, 1.0f);
+    slave->loop();
+    SimHub hub{line};
+    hub.spin(*slave, 100);
+    check(hub.reads == 1 && hub.received.count(0x10) == 1, "level starts one update");
+  }
+
+  // a slave that changes on every loop: the hub reads at the rate of the changes, every read brings data
+  void frequent_changes()
+  {
+    printf("frequent changes:\n");
+    AlertLine line;
+    SimHub hub{line};
+    auto slave = std::make_unique<SimSlave>(line);
+    for (int i = 0; i < 50; i++)
+    {
+      slave->upsert_i2c_registry(0x10, (float)i);
+      slave->loop();
+      hub.spin(*slave, 10);
+    }
+    check(hub.reads == 50, "one read per change");
+    check(hub.empty_reads == 0, "no empty reads");
+  }
+
+  // the line is only released by the slave's loop, which runs late: the level check must not read at loop rate
+  void late_release()
+  {
+    printf("line released late by the slave:\n");
+    AlertLine line;
+    SimHub hub{line};
+    auto slave = std::make_unique<SimSlave>(line);
+    slave->release_on_read = false;
+    hub.spin(*slave, 1);
+    slave->upsert_i2c_registry(0x10, 1.0f);
+    slave->loop();
+    hub.spin(*slave, 100);
+    check(hub.received.count(0x10) == 1, "hub received the change");
+    check(hub.reads == 2 && hub.empty_reads == 1, "a single empty read while the line stays low");
+    slave->loop();
+    check(line.level, "released by the slave's loop");
+  }
+} // namespace
+
+int main()
+{
+  single_change();
+  change_during_update();
+  change_before_read();
+  read_during_assert();
+  low_at_start();
+  frequent_changes();
+  late_release();
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+// Host microbenchmark: lookup and upsert cost of the flat I2CSlaveRegistry against the former
+// std::map<uint8_t, reg_val_t> registry (find() followed by operator[], as the old accessors did).
+//
+//   g++ -std=c++17 -O2 -Wall -Wextra -I components/i2c_slave tests/i2c_slave_registry_bench.cpp -o registry_bench
+//   ./registry_bench
+
+#include "i2c_slave.h"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+
+using namespace esphome::i2c_slave;
+
+namespace
+{
+  const size_t KEY_COUNT = 48;       // exported values of a typical slave
+  const size_t ITERATIONS = 2000000;
+
+  // registry entry and accessors as they were before the flat registry
+  struct map_reg_val_t
+  {
+    value_t val;
+    i2c_slave_callback_t cb;
+    void *svc_handle;
+  };
+
+  struct MapRegistry
+  {
+    std::map<uint8_t, map_reg_val_t> registry_;
+
+    void upsert(uint8_t key, float val)
+    {
+      auto it = registry_.find(key);
+      if (it == registry_.end())
+        registry_[key] = {value_t{}, NULL, nullptr};
+      registry_[key].val.value_fl = val;
+    }
+
+    map_reg_val_t *get(uint8_t key)
+    {
+      auto it = registry_.find(key);
+      if (it != registry_.end())
+        return &registry_[key];
+      return nullptr;
+    }
+  };
+
+  // keys spread over the key space, requested in a scrambled order like a master polling several sensors
+  uint8_t key_at(size_t n) { return (uint8_t)(0x10 + ((n * 7) % KEY_COUNT) * 3); }
+
+  template<typename F> double ns_per_op(F f)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+  }
+
+  volatile uint32_t sink; // keeps the lookups from being optimized away
+} // namespace
+
+int main()
+{
+  MapRegistry map_registry;
+  auto slave = std::make_unique<I2CSlave>(); // the flat registry is too large for the stack
+  for (size_t n = 0; n < KEY_COUNT; n++)
+  {
+    map_registry.upsert(key_at(n), 0.0f);
+    slave->upsert_i2c_registry(key_at(n), 0.0f);
+  }
+
+  double map_lookup = ns_per_op([&] {
+    uint32_t sum = 0;
+    for (size_t n = 0; n < ITERATIONS; n++)
+      sum += map_registry.get(key_at(n))->val.value_raw[0];
+    sink = sum;
+  });
+  double flat_lookup = ns_per_op([&] {
+    uint32_t sum = 0;
+    value_t value;
+    for (size_t n = 0; n < ITERATIONS; n++)
+      if (slave->get_i2c_registry(key_at(n))->val.load(value))
+        sum += value.value_raw[0];
+    sink = sum;
+  });
+  double map_upsert = ns_per_op([&] {
+    for (size_t n = 0; n < ITERATIONS; n++)
+      map_registry.upsert(key_at(n), (float)n);
+  });
+  double flat_upsert = ns_per_op([&] {
+    for (size_t n = 0; n < ITERATIONS; n++)
+      slave->upsert_i2c_registry(key_at(n), (float)n);
+  });
+
+  printf("%zu keys, %zu operations each\n", KEY_COUNT, ITERATIONS);
+  printf("lookup: std::map %6.2f ns, flat registry %6.2f ns\n", map_lookup, flat_lookup);
+  printf("upsert: std::map %6.2f ns, flat registry %6.2f ns\n", map_upsert, flat_upsert);
+  printf("sizeof(I2CSlaveRegistry): %zu bytes\n", sizeof(I2CSlaveRegistry));
+  return 0;
+}